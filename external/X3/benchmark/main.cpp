@@ -0,0 +1,205 @@
+// STL
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// X3
+#include <X3.h>
+#include <Textures.h>
+#include <GLState.h>
+
+// Benchmark scene: name and loader
+struct BenchScene
+{
+	std::string Name;
+	std::function<void(std::shared_ptr<X3::Scene>)> Loader;
+};
+
+// Frame timing summary
+struct BenchStats
+{
+	float Mean, P50, P90, P99, Max;
+};
+
+// Setup scenes
+void LoadDemo(std::shared_ptr<X3::Scene> scene, const std::string& meshFn);
+void LoadCubes(std::shared_ptr<X3::Scene> scene, const int& numCubes);
+void LoadBoxes(std::shared_ptr<X3::Scene> scene, const int& numBoxes);
+void LoadPoints(std::shared_ptr<X3::Scene> scene, const int& numClouds, const int& pointsPerCloud);
+
+// Helpers
+BenchStats ComputeStats(std::vector<float> samples);
+void PrintStats(const std::string& scene, const std::string& stage, const BenchStats& stats);
+void PrintCalls(const std::string& scene);
+
+// Usage: Benchmark [numFrames] [meshFile] [outputDir]
+int main(int argc, char** argv)
+{
+	// Settings
+	int numFrames = argc > 1 ? std::stoi(argv[1]) : 300;
+	std::string meshFn = argc > 2 ? argv[2] : "../data/mesh/backpack/backpack.obj";
+	std::string outDir = argc > 3 ? argv[3] : "";
+	int numWarmup = 10;
+
+	// Fixed offscreen size so runs are comparable
+	X3::Parameters& params = X3::Parameters::Inst();
+	params.RenderSettings.HeadlessDim = glm::ivec2(1280, 720);
+
+	// Init engine without window
+	std::unique_ptr<X3::Engine> engine = std::make_unique<X3::Engine>("X3 Benchmark", HEADLESS);
+	std::shared_ptr<X3::Scene> scene = engine->GetScene();
+
+	// Standard scenes
+	std::vector<BenchScene> benchScenes = {
+		{ "demo", [&](std::shared_ptr<X3::Scene> s) { LoadDemo(s, meshFn); } },
+		{ "cubes_1k", [](std::shared_ptr<X3::Scene> s) { LoadCubes(s, 1000); } },
+		{ "cubes_10k", [](std::shared_ptr<X3::Scene> s) { LoadCubes(s, 10000); } },
+		{ "boxes_5k", [](std::shared_ptr<X3::Scene> s) { LoadBoxes(s, 5000); } },
+		{ "points_1k", [](std::shared_ptr<X3::Scene> s) { LoadPoints(s, 1000, 64); } },
+		{ "points_5k", [](std::shared_ptr<X3::Scene> s) { LoadPoints(s, 5000, 64); } }
+	};
+
+	std::cout << std::left << std::setw(12) << "scene" << std::setw(8) << "stage"
+		<< std::right << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90"
+		<< std::setw(10) << "p99" << std::setw(10) << "max" << "  (ms)" << std::endl;
+
+	for (auto& bench : benchScenes)
+	{
+		// Load scene from scratch
+		scene->CallbackLoader(bench.Loader);
+		scene->Reload();
+		X3::Textures2D::Inst().Finish();
+
+		// Warm up caches, shaders and drivers
+		engine->RunFrames(numWarmup);
+
+		// Measured frames
+		std::vector<float> dtUpdate, dtRender;
+		dtUpdate.reserve(numFrames);
+		dtRender.reserve(numFrames);
+
+		for (int i = 0; i < numFrames; i++)
+		{
+			engine->RunFrames(1);
+			dtUpdate.push_back(1000.f * params.Profiler.DtUpdate);
+			dtRender.push_back(1000.f * params.Profiler.DtRender);
+		}
+
+		PrintStats(bench.Name, "update", ComputeStats(dtUpdate));
+		PrintStats(bench.Name, "render", ComputeStats(dtRender));
+		PrintCalls(bench.Name);
+
+		// Last frame for visual checks
+		if (!outDir.empty()) engine->SaveFrame(outDir + "/" + bench.Name + ".png");
+	}
+
+	return 0;
+}
+
+void LoadDemo(std::shared_ptr<X3::Scene> scene, const std::string& meshFn)
+{
+	// Objects
+	scene->AddCube();
+	scene->AddMesh(meshFn);
+
+	// Lights
+	scene->AddLight(X3::LightType::Point);
+	scene->AddLight(X3::LightType::Directional);
+}
+
+void LoadCubes(std::shared_ptr<X3::Scene> scene, const int& numCubes)
+{
+	// Fixed seed keeps the scene identical between runs
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> pos(-20.f, 20.f);
+	std::uniform_real_distribution<float> angle(0.f, 2.f * XM::PI);
+
+	for (int i = 0; i < numCubes; i++)
+	{
+		std::shared_ptr<X3::geom::Cube> cube = scene->AddCube();
+		cube->Position(glm::vec3(pos(gen), pos(gen), pos(gen)));
+		cube->PYR(glm::vec3(angle(gen), angle(gen), 0.f));
+		cube->Scale(0.2f);
+	}
+
+	// Lights
+	scene->AddLight(X3::LightType::Point);
+	scene->AddLight(X3::LightType::Directional);
+}
+
+void LoadBoxes(std::shared_ptr<X3::Scene> scene, const int& numBoxes)
+{
+	// Fixed seed keeps the scene identical between runs
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> pos(-20.f, 20.f);
+	std::uniform_real_distribution<float> size(0.1f, 1.f);
+
+	for (int i = 0; i < numBoxes; i++)
+	{
+		glm::vec3 min(pos(gen), pos(gen), pos(gen));
+		glm::vec3 max = min + glm::vec3(size(gen), size(gen), size(gen));
+
+		std::shared_ptr<X3::geom::Box> box = scene->AddBox();
+		box->BoundingBox(XM::AABB(min.x, max.x, min.y, max.y, min.z, max.z));
+	}
+}
+
+void LoadPoints(std::shared_ptr<X3::Scene> scene, const int& numClouds, const int& pointsPerCloud)
+{
+	// Fixed seed keeps the scene identical between runs
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> pos(-20.f, 20.f);
+	std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+
+	for (int i = 0; i < numClouds; i++)
+	{
+		glm::vec3 center(pos(gen), pos(gen), pos(gen));
+
+		std::vector<glm::vec3> points(pointsPerCloud);
+		for (auto& p : points) p = center + glm::vec3(offset(gen), offset(gen), offset(gen));
+
+		scene->AddPoints(points);
+	}
+}
+
+BenchStats ComputeStats(std::vector<float> samples)
+{
+	BenchStats stats = { 0.f, 0.f, 0.f, 0.f, 0.f };
+	if (samples.empty()) return stats;
+
+	// Nearest-rank percentiles
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&](float p) { return samples[std::min(samples.size() - 1, size_t(p * samples.size()))]; };
+
+	for (float s : samples) stats.Mean += s;
+	stats.Mean /= samples.size();
+	stats.P50 = percentile(0.50f);
+	stats.P90 = percentile(0.90f);
+	stats.P99 = percentile(0.99f);
+	stats.Max = samples.back();
+
+	return stats;
+}
+
+void PrintStats(const std::string& scene, const std::string& stage, const BenchStats& stats)
+{
+	std::cout << std::left << std::setw(12) << scene << std::setw(8) << stage << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(10) << stats.Mean << std::setw(10) << stats.P50 << std::setw(10) << stats.P90
+		<< std::setw(10) << stats.P99 << std::setw(10) << stats.Max << std::endl;
+}
+
+void PrintCalls(const std::string& scene)
+{
+	// State changes of the last complete frame (issued/skipped)
+	X3::GLState& state = X3::GLState::Inst();
+	auto calls = [&](X3::GLCall c) { return std::to_string(state.Issued(c)) + "/" + std::to_string(state.Skipped(c)); };
+
+	std::cout << std::left << std::setw(12) << scene << std::setw(8) << "gl" << std::right
+		<< "program " << calls(X3::GLCall::Program) << ", vao " << calls(X3::GLCall::Vao)
+		<< ", texture " << calls(X3::GLCall::Texture) << ", uniform " << calls(X3::GLCall::Uniform) << std::endl;
+}
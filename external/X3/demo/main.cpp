@@ -1,5 +1,6 @@
 // STL
 #include <iostream>
+#include <memory>
 
 // X3
 #include <X3.h>
@@ -11,7 +12,7 @@ int main()
 {
 
 	// Init engine
-	X3::Engine* engine = new X3::Engine();
+	std::unique_ptr<X3::Engine> engine = std::make_unique<X3::Engine>();
 
 	// Setup scene
 	engine->GetScene()->CallbackLoader(LoadTest);
@@ -1,10 +1,13 @@
 #version 440 core
 
+flat in vec4 InstanceColor;
+
 uniform vec3 BoxColor;
+uniform bool Instanced;
 
 out vec4 FragColor;
 
 void main() 
 {
-	FragColor = vec4(BoxColor, 1);
-}
\ No newline at end of file
+	FragColor = Instanced ? InstanceColor : vec4(BoxColor, 1);
+}
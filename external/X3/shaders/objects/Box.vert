@@ -1,12 +1,28 @@
 #version 440 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 #include "../ubo/camera.glsl"
+#include "../ubo/instances.glsl"
 
 layout (location = 0) in vec3 aPos;
 
+flat out vec4 InstanceColor;
+
 uniform mat4 model;
+uniform bool Instanced;
 
 void main()
 {
-    gl_Position = mCamera.MatP * mCamera.MatV * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+	// Batched draws read the object data from the instance buffer
+	mat4 M = model;
+	InstanceColor = vec4(1.0);
+
+	if (Instanced)
+	{
+		Instance inst = mInstances[BASE_INSTANCE + gl_InstanceID];
+		M = inst.Model;
+		InstanceColor = inst.Color;
+	}
+
+    gl_Position = mCamera.MatP * mCamera.MatV * M * vec4(aPos, 1.0);
+}
@@ -19,11 +19,18 @@ struct Material
 in vec3 Normal;
 in vec2 TexCoord;
 in vec3 FragPos;
+flat in vec4 InstanceColor;
+flat in float InstanceShininess;
 
 out vec4 FragColor;
 
 // Mesh material
 uniform Material material;
+uniform bool Instanced;
+
+// Untextured properties, per instance in batched draws
+vec4 BaseColor;
+float Shininess;
 
 
 vec3 PhongShading();
@@ -35,6 +42,8 @@ vec3 ShadingSpot(Light light, vec3 normal, vec3 viewDir, vec3 diffMap, vec3 spec
 
 void main()
 {	
+	BaseColor = Instanced ? InstanceColor : material.Color;
+	Shininess = Instanced ? InstanceShininess : material.shininess;
 	
 	vec3 result = PhongShading();
 	FragColor = vec4(result,1.0);
@@ -44,9 +53,10 @@ vec3 PhongShading()
 {
 
 	// Common vectors
-	vec4 diffMap = material.HasMaterial[0] ? texture(material.diffuse, TexCoord) : material.Color;
-	vec3 specMap = material.HasMaterial[1] ? vec3(texture(material.specular, TexCoord)) : material.Color.xyz;
-	vec3 emisMap = material.HasMaterial[2] ? vec3(texture(material.emission, TexCoord)) : vec3(0.f);
+	// Batched materials have no textures
+	vec4 diffMap = !Instanced && material.HasMaterial[0] ? texture(material.diffuse, TexCoord) : BaseColor;
+	vec3 specMap = !Instanced && material.HasMaterial[1] ? vec3(texture(material.specular, TexCoord)) : BaseColor.xyz;
+	vec3 emisMap = !Instanced && material.HasMaterial[2] ? vec3(texture(material.emission, TexCoord)) : vec3(0.f);
 	vec3 viewDir = normalize(mCamera.Pos - FragPos);
 	vec3 normal = normalize(Normal);
 	
@@ -130,7 +140,7 @@ vec3 ShadingGeneralLight(Light light, vec3 normal, vec3 viewDir, vec3 diffMap, v
 	
 	// specular
 	vec3 reflectDir = reflect(-lightDir, normal);
-	float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+	float spec = pow(max(dot(viewDir, reflectDir), 0.0), Shininess);
 	vec3 specular = light.specular * (spec * specMap);
 	
 	// emission
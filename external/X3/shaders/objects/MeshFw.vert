@@ -1,6 +1,8 @@
 #version 440 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 #include "../ubo/camera.glsl"
+#include "../ubo/instances.glsl"
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
@@ -9,13 +11,29 @@ layout (location = 2) in vec2 aTexCoord;
 out vec2 TexCoord;
 out vec3 Normal;
 out vec3 FragPos;
+flat out vec4 InstanceColor;
+flat out float InstanceShininess;
 
 uniform mat4 model;
+uniform bool Instanced;
 
 void main()
 {
-    gl_Position = mCamera.MatP * mCamera.MatV * model * vec4(aPos, 1.0);
-	Normal = mat3(transpose(inverse(model))) * aNormal;
-	FragPos = vec3(model * vec4(aPos, 1.0));
+	// Batched draws read the object data from the instance buffer
+	mat4 M = model;
+	InstanceColor = vec4(1.0);
+	InstanceShininess = 32.0;
+
+	if (Instanced)
+	{
+		Instance inst = mInstances[BASE_INSTANCE + gl_InstanceID];
+		M = inst.Model;
+		InstanceColor = inst.Color;
+		InstanceShininess = inst.Params.x;
+	}
+
+    gl_Position = mCamera.MatP * mCamera.MatV * M * vec4(aPos, 1.0);
+	Normal = mat3(transpose(inverse(M))) * aNormal;
+	FragPos = vec3(M * vec4(aPos, 1.0));
 	TexCoord = aTexCoord;
-}
\ No newline at end of file
+}
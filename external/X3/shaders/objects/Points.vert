@@ -1,16 +1,32 @@
 #version 440 core
+#extension GL_ARB_shader_draw_parameters : enable
 
 #include "../ubo/camera.glsl"
+#include "../ubo/instances.glsl"
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 
 out vec3 PointColor;
+out float PointRadius;
 
 uniform mat4 model;
+uniform bool Instanced;
+uniform float SphereRadius; // Radius of particles (in screen space)
 
 void main()
 {
-    gl_Position = mCamera.MatV * model * vec4(aPos, 1.0);
+	// Batched draws read the object data from the instance buffer
+	mat4 M = model;
+	PointRadius = SphereRadius;
+
+	if (Instanced)
+	{
+		Instance inst = mInstances[BASE_INSTANCE + gl_InstanceID];
+		M = inst.Model;
+		PointRadius = inst.Params.x;
+	}
+
+    gl_Position = mCamera.MatV * M * vec4(aPos, 1.0);
 	PointColor = aColor;
-}
\ No newline at end of file
+}
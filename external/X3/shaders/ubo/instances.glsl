@@ -0,0 +1,18 @@
+// Batched draws need the base instance, batching is turned off without the extension
+#ifdef GL_ARB_shader_draw_parameters
+#define BASE_INSTANCE gl_BaseInstanceARB
+#else
+#define BASE_INSTANCE 0
+#endif
+
+struct Instance
+{
+    mat4 Model;   // 64 bytes
+    vec4 Color;   // 16 bytes
+    vec4 Params;  // 16 bytes (x: shininess or point radius)
+};
+
+layout (std430, binding = 6) readonly buffer ssbo_instances
+{
+	Instance mInstances[];
+};
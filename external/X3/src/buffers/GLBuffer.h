@@ -52,8 +52,6 @@ namespace X3
             Bind();
             glBufferSubData(mType, offset * sizeof(T), numElements * sizeof(T), data);
             Unbind();
-
-            mNumElements = ComputeNumElements();
         }
 
         void AddData(const T* data, size_t numElements = 1)
@@ -63,7 +61,7 @@ namespace X3
             glBufferData(mType, numElements * sizeof(T), data, mUsage);
             Unbind();
 
-            mNumElements = ComputeNumElements();
+            mNumElements = numElements;
         }
 
         void AddData(const std::vector<T>& data)
@@ -73,7 +71,7 @@ namespace X3
             glBufferData(mType, data.size() * sizeof(T), data.data(), mUsage);
             Unbind();
 
-            mNumElements = ComputeNumElements();
+            mNumElements = data.size();
         }
 
         void AddData(const GLsizeiptr& numElements)
@@ -82,7 +80,39 @@ namespace X3
             glBufferData(mType, numElements * sizeof(T), 0, mUsage);
             Unbind();
 
-            mNumElements = ComputeNumElements();
+            mNumElements = numElements;
+        }
+
+        // Reads back from OpenGL to CPU
+        void GetSubData(T* data, size_t offset = 0, size_t numElements = 1)
+        {
+            Bind();
+            glGetBufferSubData(mType, offset * sizeof(T), numElements * sizeof(T), data);
+            Unbind();
+        }
+
+        // Grows the buffer keeping its current content
+        void Reserve(const size_t& numElements)
+        {
+            if (numElements <= mNumElements) return;
+
+            GLuint newID = 0;
+            glGenBuffers(1, &newID);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newID);
+            glBufferData(GL_COPY_WRITE_BUFFER, numElements * sizeof(T), 0, mUsage);
+
+            if (mNumElements > 0)
+            {
+                glBindBuffer(GL_COPY_READ_BUFFER, mID);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, mNumElements * sizeof(T));
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            }
+
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &mID);
+
+            mID = newID;
+            mNumElements = numElements;
         }
 
         // Map from OpenGL to CPU
@@ -103,17 +133,7 @@ namespace X3
             Unbind();
         }
 
-        // Compute number of elements
-        unsigned int ComputeNumElements()
-        {
-            GLint nBufferSize = 0;
-            Bind();
-            glGetBufferParameteriv(mType, GL_BUFFER_SIZE, &nBufferSize);
-            Unbind();
-
-            return (nBufferSize / sizeof(T));
-        }
-
+        // Size in elements, tracked on the CPU so it never queries the driver
         int NumElements() { return mNumElements; }
         GLuint GetID() { return mID; }
 
@@ -0,0 +1,28 @@
+#pragma once
+
+// X3
+#include <GLBuffer.h>
+
+namespace X3
+{
+    // Wraps shader storage buffer objects
+    template <class T> class Ssbo : public GLBuffer<T>
+    {
+    public:
+        // Constructor
+        Ssbo(std::vector<T> data = std::vector<T>{}, GLenum usage = GL_DYNAMIC_DRAW) : GLBuffer<T>(GL_SHADER_STORAGE_BUFFER, usage)
+        {
+            this->AddData(data);
+        };
+
+        void BindBufferBase(const GLuint& binding_index)
+        {
+            glBindBufferBase(this->mType, binding_index, this->mID);
+        }
+
+        void BindBuffersRange(const GLuint& binding_index, const GLintptr& offset, const GLsizeiptr& size)
+        {
+            glBindBufferRange(this->mType, binding_index, this->mID, offset, size);
+        }
+    };
+} // namespace X3
@@ -0,0 +1,122 @@
+// STL
+#include <stdexcept>
+#include <algorithm>
+
+// X3
+#include <StreamBuffer.h>
+#include <GLState.h>
+
+namespace X3
+{
+    StreamBuffer::StreamBuffer(GLenum type, size_t regionSize) : mType(type)
+    {
+        // Bound ranges must start at the driver's offset alignment
+        GLint alignment = 0;
+        if (type == GL_UNIFORM_BUFFER) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        else if (type == GL_SHADER_STORAGE_BUFFER) glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        mAlignment = std::max<size_t>(mAlignment, alignment);
+
+        mFrame = GLState::Inst().Frame();
+        Storage(regionSize);
+    }
+
+    StreamBuffer::~StreamBuffer()
+    {
+        for (auto& fence : mFences)
+        {
+            if (fence) glDeleteSync(fence);
+        }
+
+        if (!mRetired.empty()) glDeleteBuffers(mRetired.size(), mRetired.data());
+        if (mID != 0) glDeleteBuffers(1, &mID);
+    }
+
+    GLintptr StreamBuffer::Allocate(const size_t& bytes)
+    {
+        // First allocation of a frame moves to the next region
+        uint64_t frame = GLState::Inst().Frame();
+        if (frame != mFrame)
+        {
+            NextRegion();
+            mFrame = frame;
+        }
+
+        size_t start = Align(mHead);
+        if (start + bytes > mRegionSize)
+        {
+            Storage(std::max(2 * mRegionSize, bytes));
+            start = 0;
+        }
+
+        mHead = start + bytes;
+        return mRegion * mRegionSize + start;
+    }
+
+    void StreamBuffer::Bind()
+    {
+        glBindBuffer(mType, mID);
+    }
+
+    void StreamBuffer::Unbind()
+    {
+        glBindBuffer(mType, 0);
+    }
+
+    void StreamBuffer::BindBufferRange(const GLuint& binding, const GLintptr& offset, const GLsizeiptr& size)
+    {
+        glBindBufferRange(mType, binding, mID, offset, size);
+    }
+
+    void StreamBuffer::Storage(const size_t& regionSize)
+    {
+        // Old storage may still be bound for this frame, the driver keeps it alive for the GPU
+        if (mID != 0) mRetired.push_back(mID);
+
+        for (auto& fence : mFences)
+        {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        mRegionSize = Align(std::max<size_t>(regionSize, 1));
+        mRegion = 0;
+        mHead = 0;
+
+        // Copy target so element buffers do not touch the bound vertex array
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &mID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mID);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, NUM_REGIONS * mRegionSize, nullptr, flags);
+        mMapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, NUM_REGIONS * mRegionSize, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if (!mMapped)
+        {
+            throw std::runtime_error("Failed to map OpenGL stream buffer!");
+        }
+    }
+
+    void StreamBuffer::NextRegion()
+    {
+        // Guards the region left behind until the GPU consumed every frame issued so far
+        if (mFences[mRegion]) glDeleteSync(mFences[mRegion]);
+        mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mRegion = (mRegion + 1) % NUM_REGIONS;
+        mHead = 0;
+
+        // Region was left two frames ago, normally already signaled
+        GLsync& fence = mFences[mRegion];
+        if (fence)
+        {
+            GLenum result = glClientWaitSync(fence, 0, 0);
+            while (result == GL_TIMEOUT_EXPIRED) result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        // Bindings to retired storage were replaced last frame
+        if (!mRetired.empty()) glDeleteBuffers(mRetired.size(), mRetired.data());
+        mRetired.clear();
+    }
+} // namespace X3
@@ -0,0 +1,82 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <array>
+
+// GL
+#include <glad/glad.h>
+
+// X3
+#include <GLBuffer.h>
+
+namespace X3
+{
+    // Persistently mapped ring buffer with one region per frame in flight. The CPU writes
+    // the current region while the GPU reads the others, fences keep them apart.
+    class StreamBuffer : public GLBufferBase
+    {
+    public:
+
+        // Constructor from type and initial bytes per region
+        StreamBuffer(GLenum type, size_t regionSize = 1 << 16);
+        ~StreamBuffer();
+
+        // Copies elements into the current region and returns their byte offset
+        template <class T> GLintptr Write(const T* data, size_t numElements)
+        {
+            GLintptr offset = Allocate(numElements * sizeof(T));
+            if (numElements > 0) std::memcpy(Ptr(offset), data, numElements * sizeof(T));
+            mNumElements = numElements;
+            return offset;
+        }
+
+        template <class T> GLintptr Write(const std::vector<T>& data)
+        {
+            return Write(data.data(), data.size());
+        }
+
+        // Reserves bytes in the current region, valid until the next frame. Growing retires the
+        // storage, so bind each allocation before making the next one.
+        GLintptr Allocate(const size_t& bytes);
+        void* Ptr(const GLintptr& offset) { return mMapped + offset; }
+
+        void Bind() override;
+        void Unbind() override;
+        void BindBufferRange(const GLuint& binding, const GLintptr& offset, const GLsizeiptr& size);
+
+        // Get/Set
+        GLuint GetID() override { return mID; }
+        size_t NumElements() { return mNumElements; } // of the last write
+        size_t RegionSize() { return mRegionSize; }
+
+    private:
+
+        static constexpr int NUM_REGIONS = 3;
+
+        // Buffer data
+        GLuint mID = 0;
+        GLenum mType;
+        size_t mAlignment = 16;
+        unsigned char* mMapped = nullptr;
+        size_t mNumElements = 0;
+
+        // Ring state
+        size_t mRegionSize = 0; // bytes
+        size_t mHead = 0; // bytes used in the current region
+        int mRegion = 0;
+        uint64_t mFrame = 0;
+        std::array<GLsync, NUM_REGIONS> mFences{};
+        std::vector<GLuint> mRetired; // replaced by growth, deleted next frame
+
+        // Helpers
+        void Storage(const size_t& regionSize);
+        void NextRegion();
+        size_t Align(const size_t& bytes) { return (bytes + mAlignment - 1) / mAlignment * mAlignment; }
+
+        StreamBuffer(const StreamBuffer&) = delete; // No copy constructor allowed
+        void operator=(const StreamBuffer&) = delete; // No copy assignment allowed
+    };
+} // namespace X3
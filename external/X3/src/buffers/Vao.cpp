@@ -1,3 +1,4 @@
+#include <GLState.h>
 #include <Vao.h>
 
 namespace X3
@@ -9,7 +10,10 @@ namespace X3
 
     Vao::~Vao()
     {
-        if (mID != 0) glDeleteVertexArrays(1, &mID);
+        if (mID == 0) return;
+
+        glDeleteVertexArrays(1, &mID);
+        GLState::Inst().OnDeleteVertexArray(mID);
     }
 
     Vao::Vao(const std::vector<VertexAttrib>& attributes) : Vao()
@@ -32,12 +36,12 @@ namespace X3
 
     void Vao::Bind()
     {
-        glBindVertexArray(mID);
+        GLState::Inst().BindVertexArray(mID);
     }
 
     void Vao::Unbind()
     {
-        glBindVertexArray(0);
+        GLState::Inst().BindVertexArray(0);
     }
 
     void Vao::AddAttribs(const std::vector<VertexAttrib>& attributes, bool deleteOld)
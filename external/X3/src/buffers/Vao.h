@@ -52,6 +52,9 @@ namespace X3
 		void DeleteAttribs();
 		void Unbind();
 		void Bind();
+
+		// Get/Set
+		GLuint GetID() { return mID; }
 	private:
 		GLuint mID; // OpenGL assigned index
 		std::vector<VertexAttrib> mAttributes; // vao attributes
@@ -4,14 +4,15 @@ namespace X3
 {
 	void Camera::UpdateOrientation()
 	{
-		mPYR += mDeltaPYR;
+		// Idle cameras leave the transform store clean
+		if (mDeltaPYR != glm::vec3(0.f)) Rotate(mDeltaPYR);
 
 		mDeltaPYR = glm::vec3(0.f);
 	}
 
 	void Camera::UpdatePosition()
 	{
-		mPosition += mDeltaPos;
+		if (mDeltaPos != glm::vec3(0.f)) Translate(mDeltaPos);
 
 		mDeltaPos = glm::vec3(0.f);
 	}
@@ -28,7 +29,7 @@ namespace X3
 
 		params.MatP = MatP(aspect);
 		params.Dir = ViewVector();
-		params.Pos = mPosition;
+		params.Pos = Position();
 		params.MatV = MatV();
 
 		params.zNear = mzNear;
@@ -46,7 +47,7 @@ namespace X3
 		UboCamera params;
 		params.MatP = MatP(aspect);
 		params.Dir = ViewVector();
-		params.Pos = mPosition;
+		params.Pos = Position();
 		params.MatV = MatV();
 
 		params.zNear = mzNear;
@@ -60,8 +61,9 @@ namespace X3
 	void Camera::RenderUi()
 	{
 		ImGui::Begin("Camera");
-		ImGui::SliderFloat3("XYZ", &mPosition.x, -10.0f, 10.0f, "%.5f");
-		ImGui::SliderFloat3("PYR", &mPYR.x, -4.f, 4.f, "%.5f");
+		glm::vec3 position = Position(), pyr = PYR();
+		if (ImGui::SliderFloat3("XYZ", &position.x, -10.0f, 10.0f, "%.5f")) Position(position);
+		if (ImGui::SliderFloat3("PYR", &pyr.x, -4.f, 4.f, "%.5f")) PYR(pyr);
 		ImGui::End();
 	}
 } // namespace X3
\ No newline at end of file
@@ -5,7 +5,7 @@ namespace X3
 	CameraFPS::CameraFPS(const glm::vec3& pos, const glm::vec3& dir)
 	{
 		// Initialization
-		mPosition = pos;
+		Position(pos);
 
 		mzFar = 100.f;
 		mzNear = 0.1f;
@@ -53,7 +53,8 @@ namespace X3
 
 	glm::mat4 CameraFPS::MatV()
 	{
-		return glm::lookAt(mPosition, mPosition + ViewVector(), UpVector());
+		glm::vec3 position = Position();
+		return glm::lookAt(position, position + ViewVector(), UpVector());
 	}
 
 }
\ No newline at end of file
@@ -5,12 +5,12 @@ namespace X3
 	CameraOrbit::CameraOrbit(const glm::vec3& target, const float& distance)
 	{
 		// Orbit setup
-		mPYR = glm::vec3(glm::radians(0.f), glm::radians(0.f), 0.f);
+		PYR(glm::vec3(glm::radians(0.f), glm::radians(0.f), 0.f));
 		mDistance = distance;
 		mTarget = target;
 
 		// Position from orbit
-		mPosition = mTarget + Orientation() * glm::vec3(0.f, 0.f, mDistance);
+		Position(mTarget + Orientation() * glm::vec3(0.f, 0.f, mDistance));
 
 		// General
 		mzFar = 100.f;
@@ -26,18 +26,24 @@ namespace X3
 
 	void CameraOrbit::UpdateOrientation()
 	{
-		mPYR += mDeltaPYR;
-		mDeltaPYR = glm::vec3(0.f);
+		if (mDeltaPYR == glm::vec3(0.f)) return;
 
 		// Clamp pitch to avoid flipping
-		mPYR.x = glm::clamp(mPYR.x, glm::radians(-89.f), glm::radians(89.f));
+		glm::vec3 pyr = PYR() + mDeltaPYR;
+		pyr.x = glm::clamp(pyr.x, glm::radians(-89.f), glm::radians(89.f));
+
+		PYR(pyr);
+		mDeltaPYR = glm::vec3(0.f);
 	}
 
 	void CameraOrbit::UpdatePosition()
 	{
 		mTarget += mDeltaPos;
-		mPosition = mTarget + Orientation() * glm::vec3(0.f, 0.f, mDistance);
 		mDeltaPos = glm::vec3(0.f);
+
+		// Idle cameras leave the transform store clean
+		glm::vec3 position = mTarget + Orientation() * glm::vec3(0.f, 0.f, mDistance);
+		if (position != Position()) Position(position);
 	}
 
 	void CameraOrbit::InputHandling()
@@ -75,6 +81,6 @@ namespace X3
 
 	glm::mat4 CameraOrbit::MatV()
 	{
-		return glm::lookAt(mPosition, mTarget, UpVector());
+		return glm::lookAt(Position(), mTarget, UpVector());
 	}
 }
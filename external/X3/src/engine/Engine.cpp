@@ -1,7 +1,17 @@
+// STL
+#include <cstdlib>
+
 // X3
 #include <Materials.h>
+#include <Textures.h>
+#include <Profiler.h>
+#include <GLState.h>
 #include <Engine.h>
 
+// Image writing
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
 namespace X3
 {
     Engine::Engine(const std::string& windowTitle, WindowScreen screenAspect)
@@ -12,8 +22,11 @@ namespace X3
         InitParams(screenAspect);
         InitCallbacks();
 
-        // Init engine
-        mUi = std::make_shared<Gui>(mWindow);
+        // Shader programs build in the background while the scene loads
+        Materials::Inst().LoadShaders();
+
+        // Init engine (no UI without a visible window)
+        if (!mHeadless) mUi = std::make_shared<Gui>(mWindow);
         mScene = std::make_shared<Scene>();
 
         // Main viewport
@@ -21,12 +34,34 @@ namespace X3
         v->FullScreen(true);
     }
 
+    Engine::~Engine()
+    {
+        // GL objects are released while the context is alive, caches outlive the engine
+        mUi = nullptr;
+        mScene = nullptr;
+        mViewports.clear();
+        Materials::Inst().ClearCache();
+        Shaders::Inst().ClearProgramCache();
+        Textures2D::Inst().ClearTextureCache();
+
+        if (mFbo != 0)
+        {
+            glDeleteFramebuffers(1, &mFbo);
+            glDeleteRenderbuffers(1, &mFboColor);
+            glDeleteRenderbuffers(1, &mFboDepth);
+        }
+
+        glfwDestroyWindow(mWindow);
+        glfwTerminate();
+    }
+
     void Engine::Update()
     {
         Parameters& params = Parameters::Inst();
 
         // Profiler
         float time0 = glfwGetTime();
+        ProfileZone zone("Engine::Update");
 
         // Updates viewports
         for (auto v : mViewports)
@@ -53,6 +88,10 @@ namespace X3
         // Profiler
         Parameters& params = Parameters::Inst();
         float time0 = glfwGetTime();
+        ProfileZone zone("Engine::Render", true);
+
+        // Headless mode draws into its own framebuffer
+        if (mHeadless) glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
 
         // Render only if window not minimized
         if (params.RenderSettings.WindowDim.x > 0 && params.RenderSettings.WindowDim.y > 0)
@@ -71,9 +110,16 @@ namespace X3
             for (auto v : mViewports) v->Render(mScene);
 
             // Render UI
-            mUi->Render(this);
+            if (mUi)
+            {
+                ProfileZone uiZone("Gui::Render", true);
+                mUi->Render(this);
+            }
         }
 
+        // Nothing is presented in headless mode, so wait for the GPU to get the full frame cost
+        if (mHeadless) glFinish();
+
         params.Profiler.DtRender = glfwGetTime() - time0;
 
     }
@@ -81,6 +127,12 @@ namespace X3
     void Engine::InitOpenGL(const std::string& windowTitle, WindowScreen screenAspect)
     {
         // Initialize OpenGL
+        mHeadless = screenAspect == HEADLESS;
+
+#ifdef GLFW_PLATFORM_NULL
+        // Headless nodes have no display server, use the null platform
+        if (mHeadless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
 
         glfwInit();
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -88,6 +140,37 @@ namespace X3
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
+        if (mHeadless)
+        {
+            Parameters& params = Parameters::Inst();
+            glm::ivec2 dim = params.RenderSettings.HeadlessDim;
+
+            // Surfaceless EGL context, software OSMesa context as fallback
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+            mWindow = glfwCreateWindow(dim.x, dim.y, windowTitle.c_str(), nullptr, nullptr);
+
+            if (!mWindow)
+            {
+                glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+                mWindow = glfwCreateWindow(dim.x, dim.y, windowTitle.c_str(), nullptr, nullptr);
+            }
+
+            if (!mWindow)
+            {
+                fputs("Failed to create headless OpenGL context\n", stderr);
+                glfwTerminate();
+                exit(EXIT_FAILURE);
+            }
+
+            glfwMakeContextCurrent(mWindow);
+            gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+
+            // Offscreen render target
+            InitOffscreen();
+            return;
+        }
+
         const auto primaryMonitor = glfwGetPrimaryMonitor();
         const auto videoMode = glfwGetVideoMode(primaryMonitor);
 
@@ -105,6 +188,35 @@ namespace X3
         }
     }
 
+    void Engine::InitOffscreen()
+    {
+        Parameters& params = Parameters::Inst();
+        glm::ivec2 dim = params.RenderSettings.HeadlessDim;
+
+        // Color and depth attachments
+        glGenRenderbuffers(1, &mFboColor);
+        glBindRenderbuffer(GL_RENDERBUFFER, mFboColor);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, dim.x, dim.y);
+
+        glGenRenderbuffers(1, &mFboDepth);
+        glBindRenderbuffer(GL_RENDERBUFFER, mFboDepth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, dim.x, dim.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        // Framebuffer
+        glGenFramebuffers(1, &mFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mFboColor);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, mFboDepth);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            fputs("Headless framebuffer is not complete\n", stderr);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
     void Engine::InitCallbacks()
     {
         auto func_key_callback = [](GLFWwindow* w, int key, int scancode, int action, int mods)
@@ -144,9 +256,35 @@ namespace X3
         glfwGetFramebufferSize(mWindow, &params.RenderSettings.FrameBufferDim.x, &params.RenderSettings.FrameBufferDim.y);
         glfwGetWindowSize(mWindow, &params.RenderSettings.WindowDim.x, &params.RenderSettings.WindowDim.y);
 
+        // Offscreen target size is fixed
+        if (mHeadless)
+        {
+            params.RenderSettings.FrameBufferDim = params.RenderSettings.HeadlessDim;
+            params.RenderSettings.WindowDim = params.RenderSettings.HeadlessDim;
+        }
+
         // Sets root directory and window settings
         params.Main.RootDir = std::filesystem::path(__FILE__).parent_path().parent_path().parent_path().string();
         params.RenderSettings.mWindowScreen = screenAspect;
+
+        // Caches stay out of the source and data trees
+        if (params.Main.CacheDir.empty())
+        {
+            const char* local = std::getenv("LOCALAPPDATA");
+            const char* xdg = std::getenv("XDG_CACHE_HOME");
+            const char* home = std::getenv("HOME");
+            if (local && *local) params.Main.CacheDir = std::string(local) + "/X3";
+            else if (xdg && *xdg) params.Main.CacheDir = std::string(xdg) + "/x3";
+            else if (home && *home) params.Main.CacheDir = std::string(home) + "/.cache/x3";
+            else params.Main.CacheDir = (std::filesystem::temp_directory_path() / "x3").generic_string();
+        }
+
+        // Batched draws index the instance buffer with gl_BaseInstanceARB
+        if (params.RenderSettings.Batching && !glfwExtensionSupported("GL_ARB_shader_draw_parameters"))
+        {
+            printf("GL_ARB_shader_draw_parameters not supported, batching disabled\n");
+            params.RenderSettings.Batching = false;
+        }
     }
 
     void Engine::CallbackError(int error, const char* description)
@@ -194,40 +332,93 @@ namespace X3
         // handles input when several windows are created
     }
 
-    void Engine::Run()
+    void Engine::Frame()
     {
-        // Engine settings
+        // Profiler
         Parameters& params = Parameters::Inst();
         Input& input = Input::Inst();
+        float time0 = glfwGetTime();
+        GLState::Inst().NewFrame();
+        Profiler::Inst().NewFrame();
 
-        while (!glfwWindowShouldClose(mWindow))
         {
-            // Profiler
-            Parameters& params = Parameters::Inst();
-            float time0 = glfwGetTime();
+            ProfileZone zone("Frame", true);
+
+            // Streams decoded textures
+            Textures2D::Inst().Update();
 
             // Engine update
             Update();
             Render();
+        }
 
-            // Clears user input
-            input.ClearMouseScrollMotion();
-            input.ClearButtonsPressed();
-            input.ClearKeysPressed();
-            input.ClearMouseMotion();
+        // Clears user input
+        input.ClearMouseScrollMotion();
+        input.ClearButtonsPressed();
+        input.ClearKeysPressed();
+        input.ClearMouseMotion();
 
-            // Swap buffers and poll events
-            glfwSwapBuffers(mWindow);
-            glfwPollEvents();
+        // Back buffer contents are undefined after the swap
+        if (!mCaptureFn.empty())
+        {
+            if (!WriteFrame(mCaptureFn)) printf("Can not save frame to %s\n", mCaptureFn.c_str());
+            mCaptureFn.clear();
+        }
 
-            // Measure application time
-            params.Profiler.DtApp = glfwGetTime() - time0;
-            params.Profiler.Spf = 0.9 * params.Profiler.Spf + (1.0 - 0.9) * params.Profiler.DtApp;
+        // Swap buffers and poll events, kept out of the frame zone as it waits for vsync
+        {
+            ProfileZone zone("Swap");
+            if (!mHeadless) glfwSwapBuffers(mWindow);
+            glfwPollEvents();
         }
 
-        glfwDestroyWindow(mWindow);
-        glfwTerminate();
-        exit(EXIT_SUCCESS);
+        // Measure application time
+        params.Profiler.DtApp = glfwGetTime() - time0;
+        params.Profiler.Spf = 0.9 * params.Profiler.Spf + (1.0 - 0.9) * params.Profiler.DtApp;
+    }
+
+    void Engine::Run()
+    {
+        // Teardown is left to the destructor
+        while (!glfwWindowShouldClose(mWindow)) Frame();
+    }
+
+    void Engine::RunFrames(const int& numFrames)
+    {
+        for (int i = 0; i < numFrames && !glfwWindowShouldClose(mWindow); i++) Frame();
+    }
+
+    void Engine::ReadPixels(std::vector<unsigned char>& pixels)
+    {
+        glm::ivec2 dim = Parameters::Inst().ScreenDim();
+        pixels.resize(4 * dim.x * dim.y);
+
+        // Reads from the offscreen target or the back buffer
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, mFbo);
+        if (!mHeadless) glReadBuffer(GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, dim.x, dim.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    }
+
+    bool Engine::SaveFrame(const std::string& fn)
+    {
+        // The offscreen target keeps its contents, windows are read in the next frame
+        if (mHeadless) return WriteFrame(fn);
+
+        mCaptureFn = fn;
+        return true;
+    }
+
+    bool Engine::WriteFrame(const std::string& fn)
+    {
+        glm::ivec2 dim = Parameters::Inst().ScreenDim();
+        std::vector<unsigned char> pixels;
+        ReadPixels(pixels);
+
+        // OpenGL rows start at the bottom
+        stbi_flip_vertically_on_write(1);
+        return stbi_write_png(fn.c_str(), dim.x, dim.y, 4, pixels.data(), 4 * dim.x) != 0;
     }
 
     std::shared_ptr<Viewport> Engine::AddViewport(const std::string& name)
@@ -3,6 +3,7 @@
 // STL
 #include <filesystem>
 #include <string>
+#include <vector>
 #include <map>
 
 // GL
@@ -25,9 +26,17 @@ namespace X3
     public:
         // Main functions
         Engine(const std::string& windowTitle = "X3", WindowScreen screenAspect = SMALL);
-        virtual ~Engine() {};
+        virtual ~Engine();
         void Run();
 
+        // Runs a fixed number of frames and returns (used by headless/benchmark runs)
+        void RunFrames(const int& numFrames);
+
+        // Framebuffer readback (RGBA8, bottom row first). The back buffer of a window is only
+        // valid before the swap, windowed frames are saved at the end of the next frame
+        void ReadPixels(std::vector<unsigned char>& pixels);
+        bool SaveFrame(const std::string& fn);
+
         // Handle viewports
         std::shared_ptr<Viewport> AddViewport(const std::string& name = "Viewport");
         void RemoveViewport(std::shared_ptr<Viewport> v);
@@ -36,6 +45,7 @@ namespace X3
         // Get/Set
         std::vector<std::shared_ptr<Viewport>> Viewports() { return mViewports; }
         std::shared_ptr<Scene>& GetScene() { return mScene; }
+        bool Headless() { return mHeadless; }
 
         // Helpers to Add/Remove objects
         void LoadShader(const std::string& key, const std::vector<std::string>& files);
@@ -47,12 +57,24 @@ namespace X3
         std::shared_ptr<Scene> mScene; // Objects
         std::shared_ptr<Gui> mUi; // Graphic interface
 
+        // Offscreen target (headless mode only)
+        bool mHeadless = false;
+        GLuint mFbo = 0;
+        GLuint mFboColor = 0;
+        GLuint mFboDepth = 0;
+
+        // Pending windowed capture, written before the swap
+        std::string mCaptureFn;
+
         // Main loop
         void Update();
         void Render();
+        void Frame();
+        bool WriteFrame(const std::string& fn);
 
         // Helpers
         void InitOpenGL(const std::string& windowTitle, WindowScreen screenAspect);
+        void InitOffscreen();
         void InitParams(const WindowScreen& screenAspect);
         void InitCallbacks();
 
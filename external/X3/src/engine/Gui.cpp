@@ -1,6 +1,11 @@
+// STL
+#include <iostream>
+
 // XE
 #include <Parameters.h>
 #include <Materials.h>
+#include <Profiler.h>
+#include <GLState.h>
 #include <Engine.h>
 #include <Scene.h>
 #include <Input.h>
@@ -167,19 +172,64 @@ namespace X3
             // Tab 1
             if (ImGui::BeginTabItem("Timing"))
             {
+                Profiler& profiler = Profiler::Inst();
+
                 ImGui::Text("FPS = %.1f", 1.f / params.Profiler.Spf);
-                ImGui::Text("Time per cycle = %.5f", 1.f / params.Profiler.DtApp);
-                ImGui::Text("Time per render = %.5f", 1.f / params.Profiler.DtRender);
+                ImGui::Text("Time per cycle = %.3f ms", 1000.f * params.Profiler.DtApp);
+                ImGui::Text("Time per render = %.3f ms", 1000.f * params.Profiler.DtRender);
+
+                ImGui::Checkbox("Profiling", &params.Main.Profiling);
+                ImGui::SameLine();
+                if (ImGui::Button("Export trace"))
+                {
+                    if (profiler.ExportTrace("trace.json")) std::cout << "Profiler trace written to trace.json\n";
+                    else std::cout << "Failed to write profiler trace!\n";
+                }
+
+                // Zone tree, times in ms over the recorded frames
+                ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+                if (ImGui::BeginTable("ZoneTable", 7, flags))
+                {
+                    ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_NoHide);
+                    ImGui::TableSetupColumn("CPU avg");
+                    ImGui::TableSetupColumn("CPU min");
+                    ImGui::TableSetupColumn("CPU p99");
+                    ImGui::TableSetupColumn("GPU avg");
+                    ImGui::TableSetupColumn("GPU min");
+                    ImGui::TableSetupColumn("GPU p99");
+                    ImGui::TableHeadersRow();
+
+                    for (const int& zone : profiler.Roots()) RenderZone(zone);
+
+                    ImGui::EndTable();
+                }
+
                 ImGui::EndTabItem();
             }
 
             // Tab 2
             if (ImGui::BeginTabItem("Resources"))
             {
-                ImGui::Text("Shaders: %i", shaders.CacheSize());
+                ImGui::Text("Shaders: %i (%i from binary cache)", shaders.CacheSize(), shaders.NumBinaryHits());
                 ImGui::Text("Materials: %i", materials.CacheSize());
                 ImGui::Text("Textures: %i", textures.CacheSize());
-                // Place your content for Tab 2 here
+                if (textures.Pending() > 0) ImGui::Text("Loading textures: %i/%i", textures.Stats().Loaded, textures.Stats().Requested);
+                else ImGui::Text("Textures loaded in %.1f ms", textures.Stats().TotalMs);
+
+                // State changes of the last frame
+                GLState& state = GLState::Inst();
+                ImGui::Separator();
+                ImGui::Text("Programs: %i issued, %i skipped", state.Issued(GLCall::Program), state.Skipped(GLCall::Program));
+                ImGui::Text("Vaos: %i issued, %i skipped", state.Issued(GLCall::Vao), state.Skipped(GLCall::Vao));
+                ImGui::Text("Textures: %i issued, %i skipped", state.Issued(GLCall::Texture), state.Skipped(GLCall::Texture));
+                ImGui::Text("Uniforms: %i issued, %i skipped", state.Issued(GLCall::Uniform), state.Skipped(GLCall::Uniform));
+
+                // Draw counters of the last frame
+                Profiler& profiler = Profiler::Inst();
+                ImGui::Separator();
+                ImGui::Text("Draw calls: %i", profiler.LastCounter(Counter::DrawCalls));
+                ImGui::Text("Triangles: %i", profiler.LastCounter(Counter::Triangles));
+                ImGui::Text("Instances: %i", profiler.LastCounter(Counter::Instances));
                 ImGui::EndTabItem();
             }
 
@@ -197,6 +247,38 @@ namespace X3
         ImGui::End();
     }
 
+    void Gui::RenderZone(const int& zone)
+    {
+        Profiler& profiler = Profiler::Inst();
+        const Profiler::Zone& z = profiler.Zones()[zone];
+
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+
+        ImGuiTreeNodeFlags nodeFlags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_DefaultOpen;
+        if (z.Children.empty()) nodeFlags |= ImGuiTreeNodeFlags_Leaf;
+        bool nodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)zone, nodeFlags, "%s", z.Name.c_str());
+
+        ZoneStats cpu = profiler.Stats(zone, false);
+        ImGui::TableSetColumnIndex(1); ImGui::Text("%.3f", cpu.Avg);
+        ImGui::TableSetColumnIndex(2); ImGui::Text("%.3f", cpu.Min);
+        ImGui::TableSetColumnIndex(3); ImGui::Text("%.3f", cpu.P99);
+
+        if (z.Gpu)
+        {
+            ZoneStats gpu = profiler.Stats(zone, true);
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%.3f", gpu.Avg);
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%.3f", gpu.Min);
+            ImGui::TableSetColumnIndex(6); ImGui::Text("%.3f", gpu.P99);
+        }
+
+        if (nodeOpen)
+        {
+            for (const int& child : z.Children) RenderZone(child);
+            ImGui::TreePop();
+        }
+    }
+
     void Gui::ActivateDocking()
     {
         ///////////////////////////////////////////////////
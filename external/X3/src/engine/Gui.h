@@ -57,6 +57,7 @@ namespace X3
 		void RenderObjectProperties(const std::shared_ptr<Scene>& scene);
 		void RenderObjectTree(const std::weak_ptr<Renderable>& object);
 		void RenderProfiler();
+		void RenderZone(const int& zone);
 
 	};
 } // namespace X3
\ No newline at end of file
@@ -12,9 +12,13 @@ namespace X3
     {
         // When the key is already in the app, it adds a number until the name is unique
         std::string name = key;
-        int counter = 1;
-        while (ContainsName(name)) name = key + "_" + std::to_string(counter++);
-        NameCache.push_back(name);
+        if (ContainsName(name))
+        {
+            // Resumes from the last suffix, so repeated keys do not retry every number
+            int& counter = NameCounters[key];
+            do name = key + "_" + std::to_string(++counter); while (ContainsName(name));
+        }
+        NameCache.insert(name);
 
         return name;
     }
@@ -22,16 +26,11 @@ namespace X3
     void Names::ClearNameCache()
     {
         NameCache.clear();
+        NameCounters.clear();
     }
 
     bool Names::ContainsName(const std::string& name)
     {
-        // Checks if name already in cache
-        for (int i = 0; i < NameCache.size(); i++)
-        {
-            if (NameCache[i] == name) return true;
-        }
-
-        return false;
+        return NameCache.count(name) > 0;
     }
 }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
 
 // STL
+#include <unordered_map>
+#include <unordered_set>
 #include <string>
-#include <vector>
 #include <memory>
 
 namespace X3
@@ -28,6 +29,7 @@ namespace X3
 
 		bool ContainsName(const std::string& name);
 
-		std::vector<std::string> NameCache; // Name cache - stores object names in app
+		std::unordered_set<std::string> NameCache; // Name cache - stores object names in app
+		std::unordered_map<std::string, int> NameCounters; // next suffix to try per key
 	};
 } // namespace X3
\ No newline at end of file
@@ -12,7 +12,7 @@
 
 // Options
 enum CursorMode { NORMAL = GLFW_CURSOR_NORMAL, HIDDEN = GLFW_CURSOR_HIDDEN, DISABLED = GLFW_CURSOR_DISABLED };
-enum WindowScreen { SMALL, MAXIMIZED, FULL };
+enum WindowScreen { SMALL, MAXIMIZED, FULL, HEADLESS };
 
 // Singleton class to manage engine parameters
 namespace X3
@@ -28,11 +28,15 @@ namespace X3
         struct
         {
             std::string RootDir; // current work directory
+            std::string CacheDir; // generated caches, user cache directory unless set before the engine starts
             float MouseSens; // mouse sensitivity
             float ScrollSens; // mouse scrolling sensitivity
             float PanningSens; // mouse panning sensitivity
             bool GlCheckErrors; // check for opengl errors     
             bool ShaderAutoReload; // automatically reload shader when modified
+            bool MeshCache; // cache imported models next to their source files
+            bool ShaderCache; // cache linked shader programs on disk
+            bool Profiling; // collect profiler zones and counters
             bool ShowGui; // show gui elements
             bool ShowGuiMenuBar;
             bool ShowGuiLog;
@@ -43,10 +47,15 @@ namespace X3
             GLsizei SamplesMS; // number of multisamples
             glm::ivec2 FrameBufferDim; // the size of the default framebuffer
             glm::ivec2 WindowDim; // the size of the window
+            glm::ivec2 HeadlessDim; // the size of the offscreen framebuffer in headless mode
             CursorMode mCursorMode; // drawing mode of the mouse cursor
             WindowScreen mWindowScreen; // screen size
             bool Shadows;
             bool RenderBlending;
+            bool FrustumCulling;
+            bool Batching; // instanced/indirect draws for batchable materials
+            bool StateTracking; // skip redundant program, vao, texture and uniform changes
+            int TextureUploadMB; // texture data uploaded per frame while streaming
             glm::vec3 BGColor;
             glm::vec2 HdrExpGam;
             glm::vec3 LightAttenuation;
@@ -74,6 +83,9 @@ namespace X3
             Main.ScrollSens = 0.5f;
             Main.GlCheckErrors = false;
             Main.ShaderAutoReload = true;
+            Main.MeshCache = true;
+            Main.ShaderCache = true;
+            Main.Profiling = true;
             Main.ShowGui = true;
             Main.ShowGuiMenuBar = false;
             Main.ShowGuiLog = true;
@@ -81,6 +93,7 @@ namespace X3
             RenderSettings.SamplesMS = 4;
             RenderSettings.FrameBufferDim = glm::ivec2(0, 0);
             RenderSettings.WindowDim = glm::ivec2(0, 0);
+            RenderSettings.HeadlessDim = glm::ivec2(1280, 720);
             RenderSettings.mCursorMode = CursorMode::NORMAL;
             RenderSettings.mWindowScreen = WindowScreen::SMALL;
 
@@ -88,6 +101,10 @@ namespace X3
             RenderSettings.BGColor = glm::vec3(0.f);
             RenderSettings.HdrExpGam = glm::vec2(1.0f, 1.0f);
             RenderSettings.RenderBlending = true;
+            RenderSettings.FrustumCulling = true;
+            RenderSettings.Batching = true;
+            RenderSettings.StateTracking = true;
+            RenderSettings.TextureUploadMB = 16;
             RenderSettings.Shadows = false;
 
             Profiler.DtRender = 0.f;
@@ -0,0 +1,330 @@
+// STL
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+
+// X3
+#include <Parameters.h>
+#include <Profiler.h>
+#include <GLState.h>
+
+// Json
+#include <nlohmann/json.hpp>
+
+namespace X3
+{
+    // Trace names, indexed by Counter
+    static const char* COUNTER_NAMES[] = { "DrawCalls", "Triangles", "Instances", "Programs", "Vaos", "Textures", "Uniforms" };
+    static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == (int)Counter::Count, "Missing counter name");
+
+    Profiler& Profiler::Inst()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    Profiler::Profiler()
+    {
+        mEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Profiler::~Profiler()
+    {
+        for (auto& pool : mPools)
+        {
+            if (!pool.Queries.empty()) glDeleteQueries(pool.Queries.size(), pool.Queries.data());
+        }
+    }
+
+    void Profiler::Begin(const char* name, const bool& gpu)
+    {
+        if (!mEnabled) return;
+
+        Frame& frame = Current();
+        int parent = mStack.empty() ? -1 : frame.Events[mStack.back()].Zone;
+
+        Event e;
+        e.Zone = FindZone(name, parent, gpu);
+        e.Start = Now();
+        e.End = e.Start;
+
+        // Timestamps nest, unlike elapsed time queries
+        if (gpu)
+        {
+            QueryPool& pool = mPools[mFrame % NUM_POOLS];
+            e.QueryBegin = Query(pool);
+            glQueryCounter(pool.Queries[e.QueryBegin], GL_TIMESTAMP);
+        }
+
+        mStack.push_back(frame.Events.size());
+        frame.Events.push_back(e);
+    }
+
+    void Profiler::End()
+    {
+        if (!mEnabled || mStack.empty()) return;
+
+        Event& e = Current().Events[mStack.back()];
+        mStack.pop_back();
+
+        if (e.QueryBegin >= 0)
+        {
+            QueryPool& pool = mPools[mFrame % NUM_POOLS];
+            e.QueryEnd = Query(pool);
+            glQueryCounter(pool.Queries[e.QueryEnd], GL_TIMESTAMP);
+        }
+
+        e.End = Now();
+    }
+
+    void Profiler::NewFrame()
+    {
+        CloseFrame();
+        mFrame++;
+
+        // Reads back the frame that used this query pool before reusing it
+        ResolveGpu(mFrame - NUM_POOLS);
+        mPools[mFrame % NUM_POOLS].Used = 0;
+
+        Frame& frame = Current();
+        frame.Events.clear();
+        frame.Counters.fill(0);
+        frame.Closed = false;
+        mCounters.fill(0);
+        mStack.clear();
+
+        for (auto& zone : mZones)
+        {
+            zone.Cpu[mFrame % HISTORY] = -1.f;
+            zone.GpuMs[mFrame % HISTORY] = -1.f;
+        }
+
+        // Maps gpu timestamps to the profiler clock. The query is a round-trip to the driver
+        // and the clocks drift slowly, so it is only repeated now and then
+        mEnabled = Parameters::Inst().Main.Profiling;
+        if (mEnabled)
+        {
+            if (mCalibrated < 0 || mFrame - mCalibrated >= CALIBRATE_PERIOD)
+            {
+                GLint64 gpuNow = 0;
+                glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+                mGpuOffset = Now() - gpuNow;
+                mCalibrated = mFrame;
+            }
+
+            frame.GpuOffset = mGpuOffset;
+        }
+    }
+
+    void Profiler::CountDraw(const GLenum& primitive, const int& count, const int& instances)
+    {
+        if (!mEnabled) return;
+
+        mCounters[(int)Counter::DrawCalls]++;
+        mCounters[(int)Counter::Triangles] += Triangles(primitive, count) * instances;
+        mCounters[(int)Counter::Instances] += instances;
+    }
+
+    int Profiler::Triangles(const GLenum& primitive, const int& count)
+    {
+        if (primitive == GL_TRIANGLES) return count / 3;
+        if (primitive == GL_TRIANGLE_STRIP || primitive == GL_TRIANGLE_FAN) return std::max(count - 2, 0);
+        return 0;
+    }
+
+    ZoneStats Profiler::Stats(const int& zone, const bool& gpu) const
+    {
+        ZoneStats stats;
+        const std::array<float, HISTORY>& history = gpu ? mZones[zone].GpuMs : mZones[zone].Cpu;
+
+        std::vector<float> samples;
+        samples.reserve(HISTORY);
+        for (const float& ms : history)
+        {
+            if (ms >= 0.f) samples.push_back(ms);
+        }
+        if (samples.empty()) return stats;
+
+        // Gpu times arrive when their query pool is reused
+        int64_t last = gpu ? mFrame - NUM_POOLS : mFrame - 1;
+        if (last >= 0) stats.Last = std::max(history[last % HISTORY], 0.f);
+
+        std::sort(samples.begin(), samples.end());
+        float sum = 0.f;
+        for (const float& ms : samples) sum += ms;
+
+        stats.NumSamples = samples.size();
+        stats.Min = samples.front();
+        stats.Avg = sum / samples.size();
+        stats.P99 = samples[std::min<size_t>(samples.size() - 1, 0.99f * samples.size())];
+        return stats;
+    }
+
+    int Profiler::LastCounter(const Counter& counter) const
+    {
+        if (mFrame == 0) return 0;
+        return mFrames[(mFrame - 1) % HISTORY].Counters[(int)counter];
+    }
+
+    bool Profiler::ExportTrace(const std::string& fn) const
+    {
+        nlohmann::json events = nlohmann::json::array();
+
+        // Thread names, cpu zones on one track and gpu zones on another
+        events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", 0}, {"args", {{"name", "CPU"}}} });
+        events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 0}, {"tid", 1}, {"args", {{"name", "GPU"}}} });
+
+        for (int64_t f = std::max<int64_t>(0, mFrame - HISTORY + 1); f < mFrame; f++)
+        {
+            const Frame& frame = mFrames[f % HISTORY];
+            if (!frame.Closed || frame.Events.empty()) continue;
+
+            bool resolved = f <= mFrame - NUM_POOLS;
+            for (const Event& e : frame.Events)
+            {
+                const std::string& name = mZones[e.Zone].Name;
+                events.push_back({ {"name", name}, {"cat", "cpu"}, {"ph", "X"}, {"pid", 0}, {"tid", 0}, {"ts", e.Start / 1000.0}, {"dur", (e.End - e.Start) / 1000.0} });
+
+                if (resolved && e.QueryEnd >= 0)
+                {
+                    events.push_back({ {"name", name}, {"cat", "gpu"}, {"ph", "X"}, {"pid", 0}, {"tid", 1}, {"ts", e.GpuStart / 1000.0}, {"dur", (e.GpuEnd - e.GpuStart) / 1000.0} });
+                }
+            }
+
+            // Counters at the start of the frame
+            nlohmann::json counters;
+            for (int c = 0; c < NUM_COUNTERS; c++) counters[COUNTER_NAMES[c]] = frame.Counters[c];
+            events.push_back({ {"name", "Counters"}, {"ph", "C"}, {"pid", 0}, {"ts", frame.Events.front().Start / 1000.0}, {"args", counters} });
+        }
+
+        std::ofstream out(fn);
+        if (!out.good()) return false;
+
+        nlohmann::json trace = { {"traceEvents", events}, {"displayTimeUnit", "ms"} };
+        out << trace.dump();
+        return out.good();
+    }
+
+    std::vector<int> Profiler::Roots() const
+    {
+        std::vector<int> roots;
+        for (int i = 0; i < mZones.size(); i++)
+        {
+            if (mZones[i].Parent < 0) roots.push_back(i);
+        }
+        return roots;
+    }
+
+    int64_t Profiler::Now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - mEpoch;
+    }
+
+    int Profiler::FindZone(const char* name, const int& parent, const bool& gpu)
+    {
+        // Few children per zone, a scan beats hashing the name
+        if (parent >= 0)
+        {
+            for (const int& child : mZones[parent].Children)
+            {
+                if (mZones[child].Name == name)
+                {
+                    mZones[child].Gpu |= gpu;
+                    return child;
+                }
+            }
+        }
+        else
+        {
+            for (int i = 0; i < mZones.size(); i++)
+            {
+                if (mZones[i].Parent < 0 && mZones[i].Name == name)
+                {
+                    mZones[i].Gpu |= gpu;
+                    return i;
+                }
+            }
+        }
+
+        Zone zone;
+        zone.Name = name;
+        zone.Parent = parent;
+        zone.Depth = parent >= 0 ? mZones[parent].Depth + 1 : 0;
+        zone.Gpu = gpu;
+        zone.Cpu.fill(-1.f);
+        zone.GpuMs.fill(-1.f);
+
+        int id = mZones.size();
+        mZones.push_back(std::move(zone));
+        if (parent >= 0) mZones[parent].Children.push_back(id);
+
+        return id;
+    }
+
+    int Profiler::Query(QueryPool& pool)
+    {
+        // Grows in chunks, queries are reused every other frame
+        if (pool.Used == pool.Queries.size())
+        {
+            size_t size = pool.Queries.size();
+            pool.Queries.resize(size + 64);
+            glGenQueries(64, pool.Queries.data() + size);
+        }
+
+        return pool.Used++;
+    }
+
+    void Profiler::CloseFrame()
+    {
+        Frame& frame = Current();
+
+        // State changes are counted by the state tracker, which already closed this frame
+        GLState& state = GLState::Inst();
+        mCounters[(int)Counter::Programs] = state.Issued(GLCall::Program);
+        mCounters[(int)Counter::Vaos] = state.Issued(GLCall::Vao);
+        mCounters[(int)Counter::Textures] = state.Issued(GLCall::Texture);
+        mCounters[(int)Counter::Uniforms] = state.Issued(GLCall::Uniform);
+        frame.Counters = mCounters;
+
+        // Zones called several times in a frame add up
+        for (const Event& e : frame.Events)
+        {
+            float& ms = mZones[e.Zone].Cpu[mFrame % HISTORY];
+            ms = std::max(ms, 0.f) + (e.End - e.Start) / 1e6f;
+        }
+
+        frame.Closed = true;
+    }
+
+    void Profiler::ResolveGpu(const int64_t& f)
+    {
+        if (f < 0) return;
+
+        Frame& frame = mFrames[f % HISTORY];
+        QueryPool& pool = mPools[f % NUM_POOLS];
+
+        for (Event& e : frame.Events)
+        {
+            if (e.QueryBegin < 0 || e.QueryEnd < 0) continue;
+
+            // Never waits, samples the gpu has not reached yet are dropped
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(pool.Queries[e.QueryEnd], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available != GL_TRUE)
+            {
+                e.QueryEnd = -1;
+                continue;
+            }
+
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(pool.Queries[e.QueryBegin], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(pool.Queries[e.QueryEnd], GL_QUERY_RESULT, &end);
+
+            e.GpuStart = begin + frame.GpuOffset;
+            e.GpuEnd = end + frame.GpuOffset;
+
+            float& ms = mZones[e.Zone].GpuMs[f % HISTORY];
+            ms = std::max(ms, 0.f) + (end - begin) / 1e6f;
+        }
+    }
+} // namespace X3
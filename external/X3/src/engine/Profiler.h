@@ -0,0 +1,144 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+// GL
+#include <glad/glad.h>
+
+namespace X3
+{
+    // Per frame counters
+    enum class Counter { DrawCalls, Triangles, Instances, Programs, Vaos, Textures, Uniforms, Count };
+
+    // Statistics over the zone history, in milliseconds
+    struct ZoneStats
+    {
+        float Min = 0.f;
+        float Avg = 0.f;
+        float P99 = 0.f;
+        float Last = 0.f;
+        int NumSamples = 0;
+    };
+
+    // Singleton frame profiler. Zones nest and are identified by name and parent, so the same
+    // name under different parents is tracked separately. Render thread only.
+    class Profiler
+    {
+    public:
+
+        static constexpr int HISTORY = 240; // frames kept for stats and traces
+        static constexpr int NUM_POOLS = 4; // gpu query pools, read back when reused
+        static constexpr int CALIBRATE_PERIOD = 240; // frames between gpu clock calibrations
+
+        // Profiled region, CPU time plus optional GPU time
+        struct Zone
+        {
+            std::string Name;
+            int Parent = -1;
+            int Depth = 0;
+            bool Gpu = false;
+            std::vector<int> Children;
+            std::array<float, HISTORY> Cpu; // ms per frame, negative when not run
+            std::array<float, HISTORY> GpuMs;
+        };
+
+        // Gets the one and only instance of the profiler
+        static Profiler& Inst();
+        ~Profiler();
+
+        // Zones, use ProfileZone instead of calling them directly
+        void Begin(const char* name, const bool& gpu);
+        void End();
+
+        // Closes the frame, call once per frame before any zone
+        void NewFrame();
+
+        // Adds to a counter of the current frame
+        void Count(const Counter& counter, const int& value = 1) { if (mEnabled) mCounters[(int)counter] += value; }
+        void CountDraw(const GLenum& primitive, const int& count, const int& instances = 1);
+        static int Triangles(const GLenum& primitive, const int& count);
+
+        // Statistics of the recorded frames
+        ZoneStats Stats(const int& zone, const bool& gpu) const;
+        int LastCounter(const Counter& counter) const;
+
+        // Writes recorded frames as Chrome trace events (chrome://tracing, Perfetto)
+        bool ExportTrace(const std::string& fn) const;
+
+        // Get/Set
+        const std::vector<Zone>& Zones() const { return mZones; }
+        std::vector<int> Roots() const;
+        bool Enabled() { return mEnabled; }
+
+    private:
+
+        static constexpr int NUM_COUNTERS = (int)Counter::Count;
+
+        // Zone instance within a frame, times in ns since the profiler started
+        struct Event
+        {
+            int Zone;
+            int64_t Start;
+            int64_t End;
+            int QueryBegin = -1;
+            int QueryEnd = -1;
+            int64_t GpuStart = 0;
+            int64_t GpuEnd = 0;
+        };
+
+        struct Frame
+        {
+            std::vector<Event> Events;
+            std::array<int, NUM_COUNTERS> Counters{};
+            int64_t GpuOffset = 0; // gpu to profiler clock
+            bool Closed = false;
+        };
+
+        // Query pool of one frame
+        struct QueryPool
+        {
+            std::vector<GLuint> Queries;
+            int Used = 0;
+        };
+
+        // Data
+        std::vector<Zone> mZones;
+        std::vector<int> mStack; // open events of the current frame
+        std::array<Frame, HISTORY> mFrames;
+        std::array<QueryPool, NUM_POOLS> mPools;
+        std::array<int, NUM_COUNTERS> mCounters{};
+        int64_t mFrame = 0;
+        int64_t mEpoch;
+        int64_t mGpuOffset = 0; // gpu to profiler clock, last calibration
+        int64_t mCalibrated = -1; // frame of the last calibration
+        bool mEnabled = true;
+
+        Profiler(); // Private constructor to make class singleton
+        Profiler(const Profiler&) = delete; // No copy constructor allowed
+        void operator=(const Profiler&) = delete; // No copy assignment allowed
+
+        // Helpers
+        int64_t Now() const;
+        int FindZone(const char* name, const int& parent, const bool& gpu);
+        int Query(QueryPool& pool);
+        void CloseFrame();
+        void ResolveGpu(const int64_t& frame);
+        Frame& Current() { return mFrames[mFrame % HISTORY]; }
+    };
+
+    // Times the enclosing scope
+    class ProfileZone
+    {
+    public:
+        ProfileZone(const char* name, const bool& gpu = false) { Profiler::Inst().Begin(name, gpu); }
+        ProfileZone(const std::string& name, const bool& gpu = false) { Profiler::Inst().Begin(name.c_str(), gpu); }
+        ~ProfileZone() { Profiler::Inst().End(); }
+
+        ProfileZone(const ProfileZone&) = delete; // No copy constructor allowed
+        void operator=(const ProfileZone&) = delete; // No copy assignment allowed
+    };
+} // namespace X3
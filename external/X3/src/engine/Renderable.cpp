@@ -5,11 +5,19 @@ namespace X3
 	Renderable::Renderable()
 	{
 		mName = "Entity";
+		mTransform = Transforms::Inst().Add();
+	}
+
+	Renderable::~Renderable()
+	{
+		Transforms::Inst().Remove(mTransform);
+	}
 
-		mPosition = glm::vec3(0.f);
-		mCenter = glm::vec3(0.f);
-		mScale = glm::vec3(1.f);
-		mPYR = glm::vec3(0.f);
+	void Renderable::Parent(const std::shared_ptr<Renderable>& parent)
+	{
+		// Keeps the old link when the transform rejects the parent (cycles)
+		if (!Transforms::Inst().Parent(mTransform, parent ? parent->mTransform : -1)) return;
+		mParent = parent;
 	}
 
 	void Renderable::SetPass(const RenderPass& pass, const std::string& matName)
@@ -27,13 +35,27 @@ namespace X3
 		return mPasses.find(pass) != mPasses.end();
 	}
 
-	glm::mat4 Renderable::MatM()
+	XM::AABB Renderable::WorldBoundingBox()
 	{
-		return  glm::translate(glm::mat4(1.0f), mPosition) *
-			glm::scale(glm::mat4(1.0f), mScale) *
-			glm::translate(glm::mat4(1.0f), mCenter) *
-			glm::mat4_cast(Orientation()) *
-			glm::translate(glm::mat4(1.0f), -mCenter);
+		return TransformBox(mBoundingBox, MatM());
+	}
+
+	XM::AABB Renderable::TransformBox(const XM::AABB& box, const glm::mat4& m)
+	{
+		// Transforms box center and extents (Arvo)
+		glm::vec3 min(box.LimitsX[0], box.LimitsY[0], box.LimitsZ[0]);
+		glm::vec3 max(box.LimitsX[1], box.LimitsY[1], box.LimitsZ[1]);
+
+		glm::vec3 center = glm::vec3(m * glm::vec4(0.5f * (min + max), 1.f));
+		glm::vec3 halfSize = 0.5f * (max - min);
+		glm::vec3 extent(0.f);
+
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++) extent[i] += std::abs(m[j][i]) * halfSize[j];
+		}
+
+		return XM::AABB(center.x - extent.x, center.x + extent.x, center.y - extent.y, center.y + extent.y, center.z - extent.z, center.z + extent.z);
 	}
 
 }
\ No newline at end of file
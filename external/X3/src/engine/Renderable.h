@@ -14,8 +14,10 @@
 #include <imgui.h>
 
 // XE
+#include <Transforms.h>
 #include <Texture2D.h>
 #include <Material.h>
+#include <Batcher.h>
 #include <Shaders.h>
 #include <Vao.h>
 #include <Vbo.h>
@@ -33,13 +35,24 @@ namespace X3
     // Common objects
     enum class Objects { Cube, Mesh, Light, Quad, Camera };
 
+    // Position of an object in its scene lists, for constant time removal
+    struct SceneSlot
+    {
+        int List = -1;
+        int Index = -1;
+        int Unbounded = -1;
+    };
+
     class Renderable : public std::enable_shared_from_this<Renderable>
     {
     public:
 
         // Constructor
         Renderable();
-        virtual ~Renderable() = default;
+        virtual ~Renderable();
+
+        Renderable(const Renderable&) = delete; // Transform handles are not shared
+        void operator=(const Renderable&) = delete;
 
         // Common methods
         virtual void Select(glm::ivec4 idx) {};
@@ -53,55 +66,79 @@ namespace X3
 
         virtual GLuint GetVbo() { return 0; }
 
+        // Batching (objects whose geometry can be drawn indirectly)
+        virtual bool Batchable() { return false; }
+        virtual BatchGeometry Geometry() { return BatchGeometry(); }
+
         // Handle materials
         void SetPass(const RenderPass& pass, const std::string& matName);
         std::string MatPass(const RenderPass& pass);
         bool HasPass(const RenderPass& pass);
 
+        void FwdMaterial(const std::shared_ptr<Material>& m) { mFwdMaterial = m; }
+        std::shared_ptr<Material> FwdMaterial() { return mFwdMaterial.lock(); }
+
         // Tree structure
         std::vector<std::weak_ptr<Renderable>>& Children() { return mChildren; }
         std::weak_ptr<Renderable>& Parent() { return mParent; }
-        void Parent(const std::shared_ptr<Renderable>& parent) { mParent = parent; }
+        void Parent(const std::shared_ptr<Renderable>& parent);
         void Children(const std::shared_ptr<Renderable>& child) { mChildren.push_back(child); }
 
         // Misc
         void Name(const std::string& name) { mName = name; }
         std::string Name() { return mName; }
 
-        void BoundingBox(const XM::AABB& box) { mBoundingBox = box; }
+        void BoundingBox(const XM::AABB& box) { mBoundingBox = box; Transforms::Inst().Touch(mTransform); }
         XM::AABB& BoundingBox() { return mBoundingBox; }
+        virtual XM::AABB WorldBoundingBox();
+
+        // Culling (only objects with valid bounds are culled)
+        void Cullable(const bool& c) { mCullable = c; }
+        bool Cullable() { return mCullable; }
+
+        void Proxy(const int& p) { mProxy = p; }
+        int Proxy() { return mProxy; }
 
         void Visible(const bool& v) { mVisible = v; }
         bool Visible() { return mVisible; }
 
+        SceneSlot& Slot() { return mSlot; }
+        int Transform() { return mTransform; }
+
         // Geometry Transformations
 
+        // Local transforms live in the Transforms store, the model matrix includes the parents
+
         ///////////////////////////
         // Model matrix
-        virtual glm::mat4 MatM();
+        virtual glm::mat4 MatM() { return Transforms::Inst().World(mTransform); }
 
         // Position
-        virtual void Translate(const glm::vec3& t) { mPosition += t; }
-        virtual void Position(const glm::vec3& p) { mPosition = p; };
-        virtual glm::vec3 Position() { return mPosition; }
+        virtual void Translate(const glm::vec3& t) { Position(Position() + t); }
+        virtual void Position(const glm::vec3& p) { Transforms::Inst().Position(mTransform, p); };
+        virtual glm::vec3 Position() { return Transforms::Inst().Position(mTransform); }
 
         // Scaling
-        virtual void Scale(const float& s) { mScale = glm::vec3(s); }
-        virtual void Scale(const glm::vec3& s) { mScale = s; }
-        virtual glm::vec3 Scale() { return mScale; }
+        virtual void Scale(const float& s) { Scale(glm::vec3(s)); }
+        virtual void Scale(const glm::vec3& s) { Transforms::Inst().Scale(mTransform, s); }
+        virtual glm::vec3 Scale() { return Transforms::Inst().Scale(mTransform); }
+
+        // Pivot of rotations
+        void Center(const glm::vec3& c) { Transforms::Inst().Center(mTransform, c); }
+        glm::vec3 Center() { return Transforms::Inst().Center(mTransform); }
 
         // Rotations
-        virtual void Rotate(const glm::vec3& pyr) { mPYR += pyr; }
-        virtual void PYR(const glm::vec3& pyr) { mPYR = pyr; }
-        virtual void Pitch(const float& p) { mPYR.x = p; }
-        virtual void Roll(const float& r) { mPYR.z = r; }
-        virtual void Yaw(const float& y) { mPYR.y = y; }
-        virtual glm::vec3 PYR() { return mPYR; }
+        virtual void Rotate(const glm::vec3& pyr) { PYR(PYR() + pyr); }
+        virtual void PYR(const glm::vec3& pyr) { Transforms::Inst().PYR(mTransform, pyr); }
+        virtual void Pitch(const float& p) { glm::vec3 pyr = PYR(); pyr.x = p; PYR(pyr); }
+        virtual void Roll(const float& r) { glm::vec3 pyr = PYR(); pyr.z = r; PYR(pyr); }
+        virtual void Yaw(const float& y) { glm::vec3 pyr = PYR(); pyr.y = y; PYR(pyr); }
+        virtual glm::vec3 PYR() { return Transforms::Inst().PYR(mTransform); }
 
         // Orientation
-        virtual void Orientation(const glm::quat& q) { mPYR = glm::vec3(glm::pitch(q), glm::yaw(q), glm::roll(q)); }
-        virtual void ViewDir(const glm::vec3& dir) { mPYR.x = asin(dir.y); mPYR.y = atan2(-dir.x, -dir.z); }
-        virtual glm::quat Orientation() { return glm::quat(glm::vec3(mPYR.x, mPYR.y, mPYR.z)); }
+        virtual void Orientation(const glm::quat& q) { PYR(glm::vec3(glm::pitch(q), glm::yaw(q), glm::roll(q))); }
+        virtual void ViewDir(const glm::vec3& dir) { glm::vec3 pyr = PYR(); pyr.x = asin(dir.y); pyr.y = atan2(-dir.x, -dir.z); PYR(pyr); }
+        virtual glm::quat Orientation() { return glm::quat(PYR()); }
         virtual glm::vec3 ViewVector() { return Orientation() * glm::vec3(VEC_FWD); }
         virtual glm::vec3 UpVector() { return Orientation() * glm::vec3(VEC_UP); }
         ///////////////////////////
@@ -111,23 +148,23 @@ namespace X3
 
         // Misc data
         std::map<RenderPass, std::string> mPasses; // name of material associated to pass
+        std::weak_ptr<Material> mFwdMaterial; // forward pass material
         GLenum mPrimitive; // rendering primitive mode
         XM::AABB mBoundingBox; // Axis-aligned bounding box
         std::string mName; // renderable name
         bool mVisible = true; // visibility flag
+        bool mCullable = false; // bounding box can be used for frustum culling
+        int mProxy = -1; // scene bvh leaf
+        int mTransform; // handle in the transform store
+        SceneSlot mSlot; // scene lists
         int mDataSize; // total size of data arrays (vbos)
 
         // Tree structure
         std::vector<std::weak_ptr<Renderable>> mChildren;
         std::weak_ptr<Renderable> mParent;
 
-        // Position and orientation
-        glm::vec3 mPosition;
-        glm::vec3 mCenter;
-        glm::vec3 mScale;
-        glm::vec3 mPYR;
-
         // Helpers
         virtual void BuildBoundingBox() {};
+        static XM::AABB TransformBox(const XM::AABB& box, const glm::mat4& m);
     };
 }
\ No newline at end of file
@@ -1,5 +1,10 @@
+// STL
+#include <filesystem>
+
 // X3
 #include <Parameters.h>
+#include <MeshCache.h>
+#include <Profiler.h>
 #include <Shaders.h>
 #include <Scene.h>
 #include <Light.h>
@@ -23,6 +28,14 @@ namespace X3
 {
     void Scene::Clear()
     {
+        // Detach from spatial index and scene lists
+        for (auto& r : mRenderables) r->Proxy(-1);
+        for (auto& c : mCameras) c->Slot() = SceneSlot();
+        for (auto& l : mLights) l->Slot() = SceneSlot();
+        for (auto& r : mRenderables) r->Slot() = SceneSlot();
+        mUnbounded.clear();
+        mBvh.Clear();
+
         mRenderables.clear();
         mCameras.clear();
         mLights.clear();
@@ -30,40 +43,57 @@ namespace X3
 
     void Scene::Update()
     {
-        // Add objects
+        ProfileZone zone("Scene::Update");
+
+        Transforms& transforms = Transforms::Inst();
+
+        // Add objects, a single type check each
         for (auto& e : mAdd)
         {
-            if (std::dynamic_pointer_cast<Camera>(e) != nullptr)
+            SceneSlot& slot = e->Slot();
+            if (slot.List != -1) continue;
+
+            if (Camera* camera = dynamic_cast<Camera*>(e.get()))
             {
-                mCameras.push_back(std::dynamic_pointer_cast<Camera>(e));
+                slot.List = LIST_CAMERAS;
+                slot.Index = mCameras.size();
+                mCameras.push_back(std::shared_ptr<Camera>(e, camera));
             }
-            else if (std::dynamic_pointer_cast<Light>(e) != nullptr)
+            else if (Light* light = dynamic_cast<Light*>(e.get()))
             {
-                mLights.push_back(std::dynamic_pointer_cast<Light>(e));
+                slot.List = LIST_LIGHTS;
+                slot.Index = mLights.size();
+                mLights.push_back(std::shared_ptr<Light>(e, light));
             }
-            else if (std::dynamic_pointer_cast<Renderable>(e) != nullptr)
+            else
             {
-                mRenderables.push_back(std::dynamic_pointer_cast<Renderable>(e));
+                slot.List = LIST_RENDERABLES;
+                slot.Index = mRenderables.size();
+                mRenderables.push_back(e);
             }
         }
 
         mAdd.clear();
 
-        // Remove objects
+        // Remove objects, slots make it constant time
         for (auto& e : mRemove)
         {
-            if (std::dynamic_pointer_cast<Camera>(e) != nullptr)
-            {
-                utils::EraseFromVector(e, mCameras);
-            }
-            else if (std::dynamic_pointer_cast<Light>(e) != nullptr)
+            SceneSlot& slot = e->Slot();
+            if (slot.List == LIST_CAMERAS) SwapRemove(mCameras, slot.Index, &SceneSlot::Index);
+            else if (slot.List == LIST_LIGHTS) SwapRemove(mLights, slot.Index, &SceneSlot::Index);
+            else if (slot.List == LIST_RENDERABLES)
             {
-                utils::EraseFromVector(e, mLights);
-            }
-            else if (std::dynamic_pointer_cast<Renderable>(e) != nullptr)
-            {
-                utils::EraseFromVector(e, mRenderables);
+                SwapRemove(mRenderables, slot.Index, &SceneSlot::Index);
+
+                if (e->Proxy() != -1)
+                {
+                    mBvh.Remove(e->Proxy());
+                    e->Proxy(-1);
+                }
+                else if (slot.Unbounded != -1) SwapRemove(mUnbounded, slot.Unbounded, &SceneSlot::Unbounded);
             }
+
+            slot = SceneSlot();
         }
 
         mRemove.clear();
@@ -73,6 +103,40 @@ namespace X3
         for (auto& l : mLights) l->Update();
         for (auto& r : mRenderables) r->Update();
 
+        // World matrices, once per frame in hierarchy order
+        {
+            ProfileZone transformZone("Transforms::Update");
+            transforms.Update();
+        }
+
+        // New objects go to the spatial index with their final world matrix, moved ones are
+        // refit (only reinserted when leaving their enlarged box)
+        for (int i = 0; i < mRenderables.size(); i++)
+        {
+            std::shared_ptr<Renderable>& r = mRenderables[i];
+
+            if (r->Proxy() != -1)
+            {
+                if (transforms.Moved(r->Transform())) mBvh.Move(r->Proxy(), r->WorldBoundingBox());
+            }
+            else if (r->Slot().Unbounded == -1)
+            {
+                if (r->Cullable()) r->Proxy(mBvh.Insert(r->WorldBoundingBox(), r.get()));
+                else
+                {
+                    r->Slot().Unbounded = mUnbounded.size();
+                    mUnbounded.push_back(r);
+                }
+            }
+        }
+
+        transforms.ClearMoved();
+    }
+
+    void Scene::Cull(const Frustum& frustum, std::vector<Renderable*>& visible)
+    {
+        mBvh.Query(frustum, visible);
+        for (auto& r : mUnbounded) visible.push_back(r.get());
     }
 
     void Scene::Load()
@@ -82,13 +146,24 @@ namespace X3
 
     void Scene::SaveBinary(const std::string& fn) const
     {
+        // Only meshes are stored, procedural geometry is rebuilt by the scene loader
+        std::vector<std::shared_ptr<geom::Mesh>> meshes;
+        for (auto& r : mRenderables)
+        {
+            std::shared_ptr<geom::Mesh> mesh = std::dynamic_pointer_cast<geom::Mesh>(r);
+            if (mesh) meshes.push_back(mesh);
+        }
 
-        std::ofstream out(fn, std::ios::binary);
-        out.close();
+        // Scene files keep texture paths relative to themselves
+        std::string dir = std::filesystem::path(fn).parent_path().string();
+        if (!utils::SaveMeshCache(fn, dir, meshes)) printf("Scene: failed to save %s\n", fn.c_str());
     }
 
     void Scene::LoadBinary(const std::string& fn)
     {
+        std::vector<std::shared_ptr<geom::Mesh>> meshes;
+        std::string dir = std::filesystem::path(fn).parent_path().string();
+        if (!utils::LoadMeshCache(fn, dir, shared_from_this(), meshes)) printf("Scene: failed to load %s\n", fn.c_str());
     }
 
     std::shared_ptr<geom::Points2D> Scene::AddPoints2D(const std::vector<glm::vec2> &positions, const glm::vec3 &color)
@@ -9,6 +9,8 @@
 // X3
 #include <Renderable.h>
 #include <STLUtils.h>
+#include <Frustum.h>
+#include <Bvh.h>
 #include <Camera.h>
 #include <Light.h>
 
@@ -49,6 +51,8 @@ namespace X3
 		void SaveBinary(const std::string& fn) const;
 		void LoadBinary(const std::string& fn);
 
+		// Appends renderables overlapping the frustum plus those without bounds
+		void Cull(const Frustum& frustum, std::vector<Renderable*>& visible);
 
 		// Add/Remove scene objects
 
@@ -91,6 +95,7 @@ namespace X3
 		std::vector<std::shared_ptr<Renderable>>& Renderables() { return mRenderables; }
 		std::vector<std::shared_ptr<Camera>>& Cameras() { return mCameras; }
 		std::vector<std::shared_ptr<Light>>& Lights() { return mLights; }
+		Bvh& Hierarchy() { return mBvh; }
 
 	private:
 
@@ -99,6 +104,10 @@ namespace X3
 		std::vector<std::shared_ptr<Camera>> mCameras;
 		std::vector<std::shared_ptr<Light>> mLights;
 
+		// Spatial index (world space) and renderables that are never culled
+		std::vector<std::shared_ptr<Renderable>> mUnbounded;
+		Bvh mBvh;
+
 		// Update scene
 		std::vector<std::shared_ptr<Renderable>> mRemove;
 		std::vector<std::shared_ptr<Renderable>> mAdd;
@@ -106,7 +115,19 @@ namespace X3
 		// Loader
 		std::function<void(std::shared_ptr<Scene>)> mLoader = nullptr;
 
-		// Helpers
+		// Scene lists, see SceneSlot
+		enum { LIST_CAMERAS, LIST_LIGHTS, LIST_RENDERABLES };
 
+		// Helpers
+		template <class T>
+		static void SwapRemove(std::vector<std::shared_ptr<T>>& v, const int& i, int SceneSlot::* index)
+		{
+			if (i != v.size() - 1)
+			{
+				v[i] = std::move(v.back());
+				v[i]->Slot().*index = i;
+			}
+			v.pop_back();
+		}
 	};
 } // namespace X3
\ No newline at end of file
@@ -0,0 +1,286 @@
+// STL
+#include <algorithm>
+#include <cstdio>
+
+// X3
+#include <Transforms.h>
+
+namespace X3
+{
+    // Levels smaller than this are not worth waking the thread team for
+    static const int PARALLEL_MIN = 1024;
+
+    Transforms& Transforms::Inst()
+    {
+        static Transforms transforms;
+        return transforms;
+    }
+
+    int Transforms::Add()
+    {
+        int id;
+        if (!mFree.empty())
+        {
+            id = mFree.back();
+            mFree.pop_back();
+        }
+        else
+        {
+            id = mIndex.size();
+            mIndex.push_back(-1);
+        }
+
+        // Identity transform, its world matrix is already valid
+        mIndex[id] = mHandles.size();
+        mPosition.emplace_back(0.f);
+        mScale.emplace_back(1.f);
+        mCenter.emplace_back(0.f);
+        mPYR.emplace_back(0.f);
+        mLocal.emplace_back(1.f);
+        mWorld.emplace_back(1.f);
+        mParent.push_back(-1);
+        mNumChildren.push_back(0);
+        mOrderPos.push_back(-1);
+        mHandles.push_back(id);
+        mLocalDirty.push_back(0);
+        mWorldDirty.push_back(0);
+        mMoved.push_back(0);
+
+        // New roots go to the end of the first level
+        if (!mOrderDirty) AddToOrder(mIndex[id]);
+        return id;
+    }
+
+    void Transforms::Remove(const int& id)
+    {
+        int i = mIndex[id];
+        int last = mHandles.size() - 1;
+        bool parent = mNumChildren[i] > 0;
+
+        if (mParent[i] >= 0 && mIndex[mParent[i]] >= 0) mNumChildren[mIndex[mParent[i]]]--;
+
+        // Leaves leave their level in place, children of parents are detached by a rebuild
+        if (parent) mOrderDirty = true;
+        else if (!mOrderDirty) RemoveFromOrder(i);
+
+        // Moves the last entry into the hole
+        if (i != last)
+        {
+            mPosition[i] = mPosition[last];
+            mScale[i] = mScale[last];
+            mCenter[i] = mCenter[last];
+            mPYR[i] = mPYR[last];
+            mLocal[i] = mLocal[last];
+            mWorld[i] = mWorld[last];
+            mParent[i] = mParent[last];
+            mNumChildren[i] = mNumChildren[last];
+            mOrderPos[i] = mOrderPos[last];
+            mHandles[i] = mHandles[last];
+            mLocalDirty[i] = mLocalDirty[last];
+            mWorldDirty[i] = mWorldDirty[last];
+            mMoved[i] = mMoved[last];
+            mIndex[mHandles[i]] = i;
+            if (!mOrderDirty) mOrder[mOrderPos[i]] = i;
+        }
+
+        mPosition.pop_back();
+        mScale.pop_back();
+        mCenter.pop_back();
+        mPYR.pop_back();
+        mLocal.pop_back();
+        mWorld.pop_back();
+        mParent.pop_back();
+        mNumChildren.pop_back();
+        mOrderPos.pop_back();
+        mHandles.pop_back();
+        mLocalDirty.pop_back();
+        mWorldDirty.pop_back();
+        mMoved.pop_back();
+
+        // Nothing can refer to a leaf, its handle is free right away
+        mIndex[id] = -1;
+        if (parent) mReleased.push_back(id);
+        else mFree.push_back(id);
+    }
+
+    bool Transforms::Parent(const int& id, const int& parent)
+    {
+        if (parent >= 0 && mIndex[parent] < 0)
+        {
+            printf("Transforms: invalid parent %i\n", parent);
+            return false;
+        }
+
+        // Rejects cycles
+        for (int p = parent; p >= 0 && mIndex[p] >= 0; p = mParent[mIndex[p]])
+        {
+            if (p == id)
+            {
+                printf("Transforms: parenting %i to %i would create a cycle\n", id, parent);
+                return false;
+            }
+        }
+
+        int i = mIndex[id];
+        if (mParent[i] >= 0 && mIndex[mParent[i]] >= 0) mNumChildren[mIndex[mParent[i]]]--;
+        if (parent >= 0) mNumChildren[mIndex[parent]]++;
+
+        mParent[i] = parent;
+        mLocalDirty[i] = 1;
+        mOrderDirty = true;
+        mDirty = true;
+
+        return true;
+    }
+
+    void Transforms::Update()
+    {
+        if (!mDirty && !mOrderDirty) return;
+        if (mOrderDirty) BuildOrder();
+
+        // Parents are one level above, so each level only reads finished data
+        for (int level = 0; level + 1 < mLevels.size(); level++)
+        {
+            const int begin = mLevels[level];
+            const int end = mLevels[level + 1];
+
+            #pragma omp parallel for if (end - begin >= PARALLEL_MIN)
+            for (int k = begin; k < end; k++)
+            {
+                const int i = mOrder[k];
+                const int p = mParent[i] >= 0 ? mIndex[mParent[i]] : -1;
+
+                if (mLocalDirty[i]) mLocal[i] = LocalMatrix(mPosition[i], mScale[i], mCenter[i], mPYR[i]);
+
+                if (mLocalDirty[i] || (p >= 0 && mWorldDirty[p]))
+                {
+                    mWorld[i] = p >= 0 ? mWorld[p] * mLocal[i] : mLocal[i];
+                    mWorldDirty[i] = 1;
+                    mMoved[i] = 1;
+                }
+
+                mLocalDirty[i] = 0;
+            }
+        }
+
+        std::fill(mWorldDirty.begin(), mWorldDirty.end(), 0);
+        mDirty = false;
+    }
+
+    void Transforms::ClearMoved()
+    {
+        std::fill(mMoved.begin(), mMoved.end(), 0);
+    }
+
+    void Transforms::BuildOrder()
+    {
+        const int n = mHandles.size();
+
+        // Children of removed transforms become roots, then their handles can be reused
+        for (int i = 0; i < n; i++)
+        {
+            if (mParent[i] >= 0 && mIndex[mParent[i]] < 0)
+            {
+                mParent[i] = -1;
+                mLocalDirty[i] = 1;
+            }
+        }
+
+        mFree.insert(mFree.end(), mReleased.begin(), mReleased.end());
+        mReleased.clear();
+
+        // Depths, each chain is walked once
+        std::vector<int> depth(n, -1);
+        std::vector<int> path;
+        int maxDepth = 0;
+
+        for (int i = 0; i < n; i++)
+        {
+            int j = i;
+            path.clear();
+            while (depth[j] < 0 && mParent[j] >= 0)
+            {
+                path.push_back(j);
+                j = mIndex[mParent[j]];
+            }
+
+            if (depth[j] < 0) depth[j] = 0;
+            int d = depth[j];
+            for (auto it = path.rbegin(); it != path.rend(); ++it) depth[*it] = ++d;
+            maxDepth = std::max(maxDepth, d);
+        }
+
+        // Counting sort by depth
+        mLevels.assign(maxDepth + 2, 0);
+        for (int i = 0; i < n; i++) mLevels[depth[i] + 1]++;
+        for (int l = 1; l < mLevels.size(); l++) mLevels[l] += mLevels[l - 1];
+
+        mOrder.resize(n);
+        std::vector<int> next(mLevels.begin(), mLevels.end() - 1);
+        for (int i = 0; i < n; i++)
+        {
+            mOrderPos[i] = next[depth[i]]++;
+            mOrder[mOrderPos[i]] = i;
+        }
+
+        mOrderDirty = false;
+    }
+
+    void Transforms::AddToOrder(const int& i)
+    {
+        // The first entry of each deeper level moves to its end, opening a slot at the end of level 0
+        int hole = mOrder.size();
+        mOrder.push_back(-1);
+        mLevels.back()++;
+
+        for (int level = mLevels.size() - 2; level >= 1; level--)
+        {
+            int first = mLevels[level];
+            if (first != hole)
+            {
+                mOrder[hole] = mOrder[first];
+                mOrderPos[mOrder[hole]] = hole;
+                hole = first;
+            }
+            mLevels[level]++;
+        }
+
+        mOrder[hole] = i;
+        mOrderPos[i] = hole;
+    }
+
+    void Transforms::RemoveFromOrder(const int& i)
+    {
+        int hole = mOrderPos[i];
+        int level = std::upper_bound(mLevels.begin(), mLevels.end(), hole) - mLevels.begin() - 1;
+
+        // The last entry of each level fills the hole, which moves on to the next level and then the end
+        for (; level + 1 < mLevels.size(); level++)
+        {
+            int last = mLevels[level + 1] - 1;
+            if (last != hole)
+            {
+                mOrder[hole] = mOrder[last];
+                mOrderPos[mOrder[hole]] = hole;
+                hole = last;
+            }
+            mLevels[level + 1]--;
+        }
+
+        mOrder.pop_back();
+    }
+
+    glm::mat4 Transforms::LocalMatrix(const glm::vec3& position, const glm::vec3& scale, const glm::vec3& center, const glm::vec3& pyr)
+    {
+        // Same as T(position) * S(scale) * T(center) * R(pyr) * T(-center), without the products
+        glm::mat3 r = glm::mat3_cast(glm::quat(pyr));
+        glm::vec3 t = position + scale * (center - r * center);
+
+        glm::mat4 m;
+        m[0] = glm::vec4(scale * r[0], 0.f);
+        m[1] = glm::vec4(scale * r[1], 0.f);
+        m[2] = glm::vec4(scale * r[2], 0.f);
+        m[3] = glm::vec4(t, 1.f);
+        return m;
+    }
+} // namespace X3
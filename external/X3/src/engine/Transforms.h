@@ -0,0 +1,94 @@
+#pragma once
+
+// STL
+#include <glm/gtc/quaternion.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace X3
+{
+    // Structure-of-arrays store of object transforms. Objects keep a stable handle while the data
+    // stays dense, removal swaps the last entry into the hole. World matrices are propagated once
+    // per frame, parents before children, and only for dirty subtrees.
+    class Transforms
+    {
+    public:
+
+        // Gets the one and only instance of the store
+        static Transforms& Inst();
+
+        // Add/Remove, handles stay valid until removed
+        int Add();
+        void Remove(const int& id);
+
+        // Hierarchy, -1 for roots. Children of removed transforms become roots
+        bool Parent(const int& id, const int& parent);
+        int Parent(const int& id) const { return mParent[mIndex[id]]; }
+
+        // Recomputes dirty local matrices and propagates world matrices down the hierarchy
+        void Update();
+
+        // World matrix, flushes pending changes first
+        const glm::mat4& World(const int& id) { if (mDirty) Update(); return mWorld[mIndex[id]]; }
+
+        // World matrices changed by updates since the last ClearMoved
+        bool Moved(const int& id) const { return mMoved[mIndex[id]]; }
+        void ClearMoved();
+
+        // Get/Set of local transforms, setters flag the transform as dirty
+        const glm::vec3& Position(const int& id) const { return mPosition[mIndex[id]]; }
+        const glm::vec3& Scale(const int& id) const { return mScale[mIndex[id]]; }
+        const glm::vec3& Center(const int& id) const { return mCenter[mIndex[id]]; }
+        const glm::vec3& PYR(const int& id) const { return mPYR[mIndex[id]]; }
+
+        void Position(const int& id, const glm::vec3& p) { Touch(id); mPosition[mIndex[id]] = p; }
+        void Scale(const int& id, const glm::vec3& s) { Touch(id); mScale[mIndex[id]] = s; }
+        void Center(const int& id, const glm::vec3& c) { Touch(id); mCenter[mIndex[id]] = c; }
+        void PYR(const int& id, const glm::vec3& pyr) { Touch(id); mPYR[mIndex[id]] = pyr; }
+
+        // Flags the transform as dirty, for changes outside the store (bounds)
+        void Touch(const int& id) { mLocalDirty[mIndex[id]] = 1; mDirty = true; }
+
+        int Size() const { return mHandles.size(); }
+
+    private:
+
+        // Dense data, indexed through mIndex
+        std::vector<glm::vec3> mPosition;
+        std::vector<glm::vec3> mScale;
+        std::vector<glm::vec3> mCenter;
+        std::vector<glm::vec3> mPYR;
+        std::vector<glm::mat4> mLocal;
+        std::vector<glm::mat4> mWorld;
+        std::vector<int> mParent; // parent handle
+        std::vector<int> mNumChildren;
+        std::vector<int> mOrderPos; // position in mOrder
+        std::vector<int> mHandles; // handle of each entry
+        std::vector<uint8_t> mLocalDirty;
+        std::vector<uint8_t> mWorldDirty; // set during propagation
+        std::vector<uint8_t> mMoved;
+
+        // Handles, those of removed parents are reused after the next rebuild so stale parents can be detected
+        std::vector<int> mIndex; // dense index of each handle, -1 when free
+        std::vector<int> mFree;
+        std::vector<int> mReleased;
+
+        // Propagation order, entries grouped by depth. Roots and leaves are added and removed in place,
+        // reparenting and removing parents rebuild it
+        std::vector<int> mOrder;
+        std::vector<int> mLevels = { 0, 0 }; // first entry of each depth in mOrder, plus the end
+        bool mOrderDirty = false;
+        bool mDirty = false;
+
+        Transforms() {} // Private constructor to make class singleton
+        Transforms(const Transforms&) = delete; // No copy constructor allowed
+        void operator=(const Transforms&) = delete; // No copy assignment allowed
+
+        // Helpers
+        void BuildOrder();
+        void AddToOrder(const int& i);
+        void RemoveFromOrder(const int& i);
+        static glm::mat4 LocalMatrix(const glm::vec3& position, const glm::vec3& scale, const glm::vec3& center, const glm::vec3& pyr);
+    };
+} // namespace X3
@@ -10,10 +10,12 @@ namespace X3
 			// Set data
 			mDataSize = positions.size();
 			mPrimitive = GL_POINTS;
+			mColor = color;
 			mName = name;
 
 			// Init OpenGL buffers
-			SetupBuffers(positions, color);
+			SetupBuffers(positions);
+			UpdateAttribs();
 
 		}
 
@@ -24,6 +26,34 @@ namespace X3
 			mVao->Unbind();
 		}
 
+		void Points2D::Positions(const std::vector<glm::vec2>& positions)
+		{
+			bool resized = positions.size() != mDataSize;
+			mDataSize = positions.size();
+
+			// Streamed from now on, the plain buffer is released
+			if (!mStreamPos) mStreamPos = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, mDataSize * sizeof(glm::vec2));
+			mVboPos = nullptr;
+			mOffsetPos = mStreamPos->Write(positions);
+
+			if (resized) Colors(std::vector<glm::vec3>(mDataSize, mColor));
+			else UpdateAttribs();
+		}
+
+		void Points2D::Colors(const std::vector<glm::vec3>& colors)
+		{
+			if (colors.size() != mDataSize)
+			{
+				printf("Points2D: %s expects %i colors\n", mName.c_str(), mDataSize);
+				return;
+			}
+
+			if (!mStreamColor) mStreamColor = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, mDataSize * sizeof(glm::vec3));
+			mVboColor = nullptr;
+			mOffsetColor = mStreamColor->Write(colors);
+			UpdateAttribs();
+		}
+
 		void Points2D::RenderUi()
 		{
 			ImGui::Text("Name: %s", mName.c_str());
@@ -31,19 +61,24 @@ namespace X3
 			ImGui::Checkbox("Render", &mVisible);
 		}
 
-		void Points2D::SetupBuffers(const std::vector<glm::vec2>& positions, const glm::vec3& color)
+		void Points2D::SetupBuffers(const std::vector<glm::vec2>& positions)
 		{
-			// Set equal color for all points
-			std::vector<glm::vec3> colors(mDataSize, color);
-
-			// Init render data
+			// Init render data, positions may be written by interop
 			mVboPos = std::make_shared<Vbo<glm::vec2>>(positions, GL_DYNAMIC_DRAW);
-			mVboColor = std::make_shared<Vbo<glm::vec3>>(colors, GL_DYNAMIC_DRAW);
+			mVboColor = std::make_shared<Vbo<glm::vec3>>(std::vector<glm::vec3>(mDataSize, mColor));
+			mVao = std::make_shared<Vao>();
+		}
 
-			mVao = std::make_shared<Vao>(std::vector<VertexAttrib>{
-				VertexAttrib(mVboPos, 0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0),
-				VertexAttrib(mVboColor, 1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0)
+		void Points2D::UpdateAttribs()
+		{
+			// Each write moves streamed data within the rings
+			std::shared_ptr<GLBufferBase> pos = mStreamPos ? std::static_pointer_cast<GLBufferBase>(mStreamPos) : mVboPos;
+			std::shared_ptr<GLBufferBase> color = mStreamColor ? std::static_pointer_cast<GLBufferBase>(mStreamColor) : mVboColor;
+			mVao->AddAttribs(std::vector<VertexAttrib>{
+				VertexAttrib(pos, 0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)(mStreamPos ? mOffsetPos : 0)),
+				VertexAttrib(color, 1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(mStreamColor ? mOffsetColor : 0))
 			});
+			mVao->UpdateVertAttribPointers();
 		}
 	}
 }
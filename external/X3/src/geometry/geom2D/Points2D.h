@@ -9,6 +9,7 @@
 // X3
 #include <Renderable.h>
 #include <Materials.h>
+#include <StreamBuffer.h>
 #include <Textures.h>
 #include <Vao.h>
 #include <Vbo.h>
@@ -29,15 +30,27 @@ namespace X3
 			void Render() override;
 			void RenderUi() override;
 
+			// Streams new data without reallocating, a new count resets colors to the base color.
+			// Updated data moves to ring buffers, for point clouds rewritten every frame
+			void Positions(const std::vector<glm::vec2>& positions);
+			void Colors(const std::vector<glm::vec3>& colors);
+
 		protected:
 
-			// Render data
-            std::shared_ptr<Vbo<glm::vec2>> mVboPos;
+			// Points data
+			glm::vec3 mColor;
+
+			// Render data. Data given at construction stays in plain buffers, updated data is
+			// streamed through rings created on first update, starting at the offsets
+			std::shared_ptr<Vbo<glm::vec2>> mVboPos;
 			std::shared_ptr<Vbo<glm::vec3>> mVboColor;
+			std::shared_ptr<StreamBuffer> mStreamPos, mStreamColor;
+			GLintptr mOffsetPos = 0, mOffsetColor = 0;
 			std::shared_ptr<Vao> mVao;
 
 			// Helpers
-			void SetupBuffers(const std::vector<glm::vec2>& positions, const glm::vec3& color);
+			void SetupBuffers(const std::vector<glm::vec2>& positions);
+			void UpdateAttribs();
 		};
 
 	} // namespace geom
@@ -11,6 +11,7 @@ namespace X3
 
 			// Setup additional properties
 			mPrimitive = GL_LINES;
+			mCullable = true;
 			mName = name;
 
 			// Build GPU buffers
@@ -24,6 +25,7 @@ namespace X3
 
 			// Setup additional properties
 			mPrimitive = GL_LINES;
+			mCullable = true;
 			mName = name;
 
 			// Build GPU buffers
@@ -37,28 +39,40 @@ namespace X3
 
 			// Setup additional properties
 			mPrimitive = GL_LINES;
+			mCullable = true;
 			mName = name;
 
 			// Build GPU buffers
 			SetupBuffers();
 		}
 
-		void Box::ReDraw()
+		void Box::Render()
+		{
+			mVao->Bind();
+			glDrawElements(mPrimitive, 24, GL_UNSIGNED_INT, 0);
+		}
+
+		glm::mat4 Box::MatM()
 		{
-			// Resets buffers
-			mVao.reset();
-			mEbo.reset();
-			mVbo.reset();
+			glm::vec3 min(mBoundingBox.LimitsX[0], mBoundingBox.LimitsY[0], mBoundingBox.LimitsZ[0]);
+			glm::vec3 max(mBoundingBox.LimitsX[1], mBoundingBox.LimitsY[1], mBoundingBox.LimitsZ[1]);
 
-			// Setup new data
-			SetupBuffers();
+			return Renderable::MatM() * glm::translate(glm::mat4(1.0f), min) * glm::scale(glm::mat4(1.0f), max - min);
 		}
 
-		void Box::Render()
+		XM::AABB Box::WorldBoundingBox()
 		{
-			mVao->Bind();
-			glDrawElements(mPrimitive, 24, GL_UNSIGNED_INT, 0);
-			mVao->Unbind();
+			return TransformBox(XM::AABB(0.f, 1.f), MatM());
+		}
+
+		BatchGeometry Box::Geometry()
+		{
+			BatchGeometry geometry;
+			geometry.Vao = mVao->GetID();
+			geometry.Primitive = mPrimitive;
+			geometry.Indexed = true;
+			geometry.Count = 24;
+			return geometry;
 		}
 
 		void Box::RenderUi()
@@ -69,20 +83,30 @@ namespace X3
 
 		void Box::SetupBuffers()
 		{
+			// Unit box shared by every box
+			static std::weak_ptr<Vbo<glm::vec3>> sVbo;
+			static std::weak_ptr<Vbo<int>> sEbo;
+			static std::weak_ptr<Vao> sVao;
+
+			mVbo = sVbo.lock();
+			mEbo = sEbo.lock();
+			mVao = sVao.lock();
+			if (mVbo && mEbo && mVao) return;
+
 			// Builds data before sending to gpu
 			std::vector<glm::vec3> vertices;
 
 			// Bottom face
-			vertices.emplace_back(mBoundingBox.LimitsX[0], mBoundingBox.LimitsY[0], mBoundingBox.LimitsZ[0]); // Bottom-left-back
-			vertices.emplace_back(mBoundingBox.LimitsX[1], mBoundingBox.LimitsY[0], mBoundingBox.LimitsZ[0]); // Bottom-right-back
-			vertices.emplace_back(mBoundingBox.LimitsX[1], mBoundingBox.LimitsY[0], mBoundingBox.LimitsZ[1]); // Bottom-right-front
-			vertices.emplace_back(mBoundingBox.LimitsX[0], mBoundingBox.LimitsY[0], mBoundingBox.LimitsZ[1]); // Bottom-left-front
+			vertices.emplace_back(0, 0, 0); // Bottom-left-back
+			vertices.emplace_back(1, 0, 0); // Bottom-right-back
+			vertices.emplace_back(1, 0, 1); // Bottom-right-front
+			vertices.emplace_back(0, 0, 1); // Bottom-left-front
 
 			// Top face
-			vertices.emplace_back(mBoundingBox.LimitsX[0], mBoundingBox.LimitsY[1], mBoundingBox.LimitsZ[0]); // Top-left-back
-			vertices.emplace_back(mBoundingBox.LimitsX[1], mBoundingBox.LimitsY[1], mBoundingBox.LimitsZ[0]); // Top-right-back
-			vertices.emplace_back(mBoundingBox.LimitsX[1], mBoundingBox.LimitsY[1], mBoundingBox.LimitsZ[1]); // Top-right-front
-			vertices.emplace_back(mBoundingBox.LimitsX[0], mBoundingBox.LimitsY[1], mBoundingBox.LimitsZ[1]); // Top-left-front
+			vertices.emplace_back(0, 1, 0); // Top-left-back
+			vertices.emplace_back(1, 1, 0); // Top-right-back
+			vertices.emplace_back(1, 1, 1); // Top-right-front
+			vertices.emplace_back(0, 1, 1); // Top-left-front
 
 			std::vector<int> indices = {
 				// Bottom face edges
@@ -94,12 +118,16 @@ namespace X3
 			};
 
 			// Init render data
-			mEbo = std::make_shared<Vbo<int>>(indices, GL_DYNAMIC_DRAW, GL_ELEMENT_ARRAY_BUFFER);
-			mVbo = std::make_shared<Vbo<glm::vec3>>(vertices, GL_DYNAMIC_DRAW);
+			mEbo = std::make_shared<Vbo<int>>(indices, GL_STATIC_DRAW, GL_ELEMENT_ARRAY_BUFFER);
+			mVbo = std::make_shared<Vbo<glm::vec3>>(vertices, GL_STATIC_DRAW);
 
 			mVao = std::make_shared<Vao>(std::vector<VertexAttrib>{VertexAttrib(mVbo, 0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0)});
 
 			mVao->BindEbo(mEbo);
+
+			sVbo = mVbo;
+			sEbo = mEbo;
+			sVao = mVao;
 		}
 	} // namespace geom
 } // namespace X3
\ No newline at end of file
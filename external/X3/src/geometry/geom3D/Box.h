@@ -28,11 +28,17 @@ namespace X3
 			Box(XM::AABB bounds, const std::string& name = "box");
 			Box() {};
 
-			void ReDraw() override;
-
 			void Render() override;
 			void RenderUi() override;
 
+			// Bounds are applied on top of the unit box geometry
+			glm::mat4 MatM() override;
+			XM::AABB WorldBoundingBox() override;
+
+			// Batching (all boxes share the unit box geometry)
+			bool Batchable() override { return true; }
+			BatchGeometry Geometry() override;
+
 		protected:
 
 			// Render data
@@ -58,9 +58,16 @@ namespace X3
 
             for (int i = 0; i < 36; i++) mIndices[i] = i;
 
-            // Init mesh
+            // Init mesh, all cubes share the same pool range
+            static std::weak_ptr<MeshRange> sRange;
+
             SetupGeometry();
-            SetupBuffers();
+            mRange = sRange.lock();
+            if (!mRange)
+            {
+                SetupBuffers();
+                sRange = mRange;
+            }
         }
     } // namespace geom
 } // namespace X3
\ No newline at end of file
@@ -19,8 +19,33 @@ namespace X3
 
 		}
 
+		Mesh::Mesh(const Vertex* vertices, const int& numVertices, const int* indices, const int& numIndices, const XM::AABB& bounds, const glm::vec3& center, const std::string& name)
+		{
+			// Set data, geometry goes straight to the pool
+			mPrimitive = GL_TRIANGLES;
+			mBoundingBox = bounds;
+			mCullable = numVertices > 0;
+			Center(center);
+			mName = name;
+
+			mRange = MeshPool::Inst().Allocate(vertices, numVertices, indices, numIndices);
+		}
+
+		std::vector<Vertex> Mesh::Vertices()
+		{
+			FetchData();
+			return mVertices;
+		}
+
+		std::vector<int> Mesh::Indices()
+		{
+			FetchData();
+			return mIndices;
+		}
+
 		std::vector<glm::vec3> Mesh::VertexPositions()
 		{
+			FetchData();
 			int size = mVertices.size();
 			std::vector<glm::vec3> vertices(size);
 
@@ -36,6 +61,7 @@ namespace X3
 		std::vector<Triangle> Mesh::Triangles()
 		{
 			// Fill triangle array based on mesh indices
+			FetchData();
 			int size = mIndices.size() / 3;
 			std::vector<Triangle> triangles(size);
 
@@ -69,29 +95,48 @@ namespace X3
 
 		void Mesh::Render()
 		{
-			mVao->Bind();
-			glDrawElements(mPrimitive, mIndices.size(), GL_UNSIGNED_INT, 0);
-			mVao->Unbind();
+			// Meshes built by subclasses without geometry have no pool range
+			if (!mRange) return;
+
+			std::shared_ptr<Vao>& vao = MeshPool::Inst().GetVao();
+
+			vao->Bind();
+			glDrawElementsBaseVertex(mPrimitive, mRange->NumIndices, GL_UNSIGNED_INT, (void*)(mRange->FirstIndex * sizeof(int)), mRange->BaseVertex);
+		}
+
+		BatchGeometry Mesh::Geometry()
+		{
+			BatchGeometry geometry;
+			geometry.Vao = MeshPool::Inst().GetVao()->GetID();
+			geometry.Primitive = mPrimitive;
+			geometry.Indexed = true;
+			geometry.First = mRange->FirstIndex;
+			geometry.Count = mRange->NumIndices;
+			geometry.BaseVertex = mRange->BaseVertex;
+			return geometry;
 		}
 
 		void Mesh::RenderUi()
 		{
 			ImGui::Text("Name: %s", mName.c_str());
 			ImGui::Text("Material: %s", mPasses[RenderPass::Forward].c_str());
-			ImGui::DragFloat3("Position", &mPosition.x, 0.2f, -20.0f, 20.0f, "%.5f");
-			ImGui::DragFloat3("PYR", &mPYR.x, 0.02f, 0.f, 2 * 3.14159f, "%.5f");
-			ImGui::InputFloat3("Scale", &mScale.x);
+
+			// Edits copies, the transform store only hears about actual changes
+			glm::vec3 position = Position(), pyr = PYR(), scale = Scale();
+			if (ImGui::DragFloat3("Position", &position.x, 0.2f, -20.0f, 20.0f, "%.5f")) Position(position);
+			if (ImGui::DragFloat3("PYR", &pyr.x, 0.02f, 0.f, 2 * 3.14159f, "%.5f")) PYR(pyr);
+			if (ImGui::InputFloat3("Scale", &scale.x)) Scale(scale);
 		}
 
 		void Mesh::SetupGeometry()
 		{
 			// Computes geometry's center
-			mCenter = glm::vec3(0.f);
+			glm::vec3 center(0.f);
 			for (int i = 0; i < mVertices.size(); i++)
 			{
-				mCenter += mVertices[i].Position;
+				center += mVertices[i].Position;
 			}
-			mCenter /= mVertices.size();
+			Center(center / (float)mVertices.size());
 
 			// Computes bounding box
 			float maxX = std::numeric_limits<float>::lowest();
@@ -114,23 +159,21 @@ namespace X3
 				if (vertex.Position.z > maxZ) maxZ = vertex.Position.z;
 			}
 
-			mBoundingBox = XM::AABB(minX, maxX, minY, maxY, minZ, maxZ);
+			BoundingBox(XM::AABB(minX, maxX, minY, maxY, minZ, maxZ));
+			mCullable = !mVertices.empty();
 
 		}
 
-		void Mesh::SetupBuffers()
+		void Mesh::FetchData()
 		{
-			// Init render data
-			mEbo = std::make_shared<Vbo<int>>(mIndices, GL_STATIC_DRAW, GL_ELEMENT_ARRAY_BUFFER);
-			mVbo = std::make_shared<Vbo<Vertex>>(mVertices);
-
-			mVao = std::make_shared<Vao>(std::vector<VertexAttrib>{
-				VertexAttrib(mVbo, 0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0),
-				VertexAttrib(mVbo, 1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, Normal))),
-				VertexAttrib(mVbo, 2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, TexCoord)))
-			});
+			// Reads back geometry of meshes built without a CPU copy
+			if (mVertices.empty() && mRange && mRange->NumVertices > 0) MeshPool::Inst().Read(*mRange, mVertices, mIndices);
+		}
 
-			mVao->BindEbo(mEbo);
+		void Mesh::SetupBuffers()
+		{
+			// Copy geometry into the shared pool
+			mRange = MeshPool::Inst().Allocate(mVertices, mIndices);
 		}
 	} // namespace geom
 } // namespace X3
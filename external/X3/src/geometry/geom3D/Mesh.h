@@ -12,6 +12,7 @@
 #include <Renderable.h>
 #include <Materials.h>
 #include <Textures.h>
+#include <MeshPool.h>
 #include <Vao.h>
 #include <Vbo.h>
 
@@ -42,31 +43,35 @@ namespace X3
 
 			// Common methods
 			Mesh(const std::vector<Vertex>& vertices, const std::vector<int>& indices, const std::string& name = "mesh");
+			Mesh(const Vertex* vertices, const int& numVertices, const int* indices, const int& numIndices, const XM::AABB& bounds, const glm::vec3& center, const std::string& name = "mesh");
 			Mesh() {};
 
 			void Render() override;
 			void RenderUi() override;
 
+			// Batching (all meshes live in the shared mesh pool)
+			bool Batchable() override { return mRange != nullptr; }
+			BatchGeometry Geometry() override;
+
 			// Get/Set
-			std::vector<Vertex> Vertices() { return mVertices; }
-			std::vector<int> Indices() { return mIndices; }
+			std::vector<Vertex> Vertices();
+			std::vector<int> Indices();
 			std::vector<glm::vec3> VertexPositions();
 			std::vector<Triangle> Triangles();
 
 		protected:
 
-			// Mesh data
+			// Mesh data (meshes built from memory keep no copy until asked for it)
 			std::vector<Vertex> mVertices;
 			std::vector<int> mIndices;
 
 			// Render data
-			std::shared_ptr<Vbo<Vertex>> mVbo;
-			std::shared_ptr<Vbo<int>> mEbo;
-			std::shared_ptr<Vao> mVao;
+			std::shared_ptr<MeshRange> mRange; // slice of the mesh pool
 
 			// Helpers
 			void SetupGeometry();
 			void SetupBuffers();
+			void FetchData();
 		};
 
 	} // namespace geom
@@ -0,0 +1,368 @@
+// STL
+#include <filesystem>
+#include <cstring>
+#include <fstream>
+#include <cstdio>
+#include <map>
+
+// X3
+#include <Parameters.h>
+#include <MappedFile.h>
+#include <MeshCache.h>
+#include <Profiler.h>
+#include <Names.h>
+#include <Mesh.h>
+
+namespace X3
+{
+	namespace utils
+	{
+		// Bump when the layout or the import post-processing changes
+		static const uint32_t CACHE_VERSION = 2; // 2: child nodes parented to the first mesh of their node
+		static const char CACHE_MAGIC[4] = { 'X', '3', 'M', 'C' };
+		static const uint32_t NO_ENTRY = 0xFFFFFFFF;
+		static const uint64_t BLOB_ALIGNMENT = 16;
+
+		// Range check written so corrupt offsets can not wrap around
+		static bool Inside(const uint64_t& offset, const uint64_t& bytes, const uint64_t& size)
+		{
+			return bytes <= size && offset <= size - bytes;
+		}
+
+		// Layout: header, mesh records, material records, string table and aligned blobs
+		struct CacheHeader
+		{
+			char Magic[4];
+			uint32_t Version;
+			uint64_t SourceSize;
+			int64_t SourceTime;
+			uint32_t NumMeshes;
+			uint32_t NumMaterials;
+			uint64_t StringsOffset;
+			uint64_t StringsSize;
+		};
+
+		struct CacheMesh
+		{
+			uint64_t VertexOffset;
+			uint64_t IndexOffset;
+			uint32_t NumVertices;
+			uint32_t NumIndices;
+			uint32_t Name; // string table offset
+			int32_t Material; // material record
+			int32_t Parent; // mesh record, -1 for roots
+			uint32_t Padding;
+			float Bounds[6]; // min/max per axis
+			float Center[3];
+			float Position[3];
+			float Scale[3];
+			float PYR[3];
+		};
+
+		struct CacheMaterial
+		{
+			uint32_t Name; // NO_ENTRY when named after its mesh
+			uint32_t Maps[3]; // texture paths relative to the model, indexed by MapType
+		};
+
+		static_assert(sizeof(CacheHeader) == 48, "Cache header layout changed");
+		static_assert(sizeof(CacheMesh) == 112, "Cache mesh layout changed");
+		static_assert(sizeof(CacheMaterial) == 16, "Cache material layout changed");
+		static_assert(sizeof(geom::Vertex) == 32, "Vertex layout is part of the cache format");
+
+		static uint64_t Align(const uint64_t& offset)
+		{
+			return (offset + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+		}
+
+		SourceStamp FileStamp(const std::string& fn)
+		{
+			SourceStamp stamp;
+			std::error_code ec;
+
+			auto size = std::filesystem::file_size(fn, ec);
+			if (ec) return stamp;
+			auto time = std::filesystem::last_write_time(fn, ec);
+			if (ec) return stamp;
+
+			stamp.Size = size;
+			stamp.Time = time.time_since_epoch().count();
+			return stamp;
+		}
+
+		std::string MeshCacheFn(const std::string& fn)
+		{
+			// One file per source path, named after the model to stay readable
+			std::filesystem::path src = std::filesystem::absolute(fn).lexically_normal();
+			char hash[17];
+			snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)std::hash<std::string>()(src.generic_string()));
+			return Parameters::Inst().Main.CacheDir + "/meshes/" + src.stem().string() + "_" + hash + ".x3c";
+		}
+
+		bool SaveMeshCache(const std::string& fn, const std::string& modelDir, const std::vector<std::shared_ptr<geom::Mesh>>& meshes, const SourceStamp& stamp)
+		{
+			ProfileZone zone("utils::SaveMeshCache");
+
+			// Managers
+			Materials& materials = Materials::Inst();
+			std::filesystem::path dir = std::filesystem::absolute(modelDir.empty() ? "." : modelDir).lexically_normal();
+
+			// String table, repeated strings are stored once
+			std::string strings;
+			std::map<std::string, uint32_t> stringIds;
+			auto addString = [&](const std::string& s)
+			{
+				auto it = stringIds.find(s);
+				if (it != stringIds.end()) return it->second;
+
+				uint32_t id = strings.size();
+				strings.append(s);
+				strings.push_back('\0');
+				stringIds[s] = id;
+				return id;
+			};
+
+			// Mesh data (read back from the GPU for meshes without a CPU copy)
+			std::vector<std::vector<geom::Vertex>> vertices(meshes.size());
+			std::vector<std::vector<int>> indices(meshes.size());
+			std::vector<CacheMesh> records(meshes.size());
+			std::vector<CacheMaterial> matRecords;
+			std::map<std::string, int32_t> matIds;
+
+			for (int i = 0; i < meshes.size(); i++)
+			{
+				const std::shared_ptr<geom::Mesh>& mesh = meshes[i];
+				vertices[i] = mesh->Vertices();
+				indices[i] = mesh->Indices();
+
+				CacheMesh& r = records[i];
+				std::memset(&r, 0, sizeof(CacheMesh));
+				r.NumVertices = vertices[i].size();
+				r.NumIndices = indices[i].size();
+				r.Name = addString(mesh->Name());
+
+				XM::AABB& box = mesh->BoundingBox();
+				float bounds[6] = { box.LimitsX[0], box.LimitsX[1], box.LimitsY[0], box.LimitsY[1], box.LimitsZ[0], box.LimitsZ[1] };
+				glm::vec3 center = mesh->Center(), position = mesh->Position(), scale = mesh->Scale(), pyr = mesh->PYR();
+				std::memcpy(r.Bounds, bounds, sizeof(bounds));
+				std::memcpy(r.Center, &center.x, sizeof(r.Center));
+				std::memcpy(r.Position, &position.x, sizeof(r.Position));
+				std::memcpy(r.Scale, &scale.x, sizeof(r.Scale));
+				std::memcpy(r.PYR, &pyr.x, sizeof(r.PYR));
+
+				// Hierarchy among the saved meshes
+				r.Parent = -1;
+				std::shared_ptr<Renderable> parent = mesh->Parent().lock();
+				for (int j = 0; parent && j < meshes.size(); j++)
+				{
+					if (meshes[j] == parent) r.Parent = j;
+				}
+
+				// Material, shared between meshes using the same one
+				std::string matName = mesh->MatPass(RenderPass::Forward);
+				auto it = matIds.find(matName);
+				if (it != matIds.end())
+				{
+					r.Material = it->second;
+					continue;
+				}
+
+				CacheMaterial m;
+				m.Name = matName == mesh->Name() ? NO_ENTRY : addString(matName);
+
+				std::shared_ptr<MeshMaterial> material = std::dynamic_pointer_cast<MeshMaterial>(materials.GetMaterial(matName));
+				for (int k = 0; k < 3; k++)
+				{
+					m.Maps[k] = NO_ENTRY;
+					if (!material) continue;
+
+					auto map = material->MatMaps().find(static_cast<MapType>(k));
+					std::shared_ptr<Texture2D> texture = map != material->MatMaps().end() ? map->second.lock() : nullptr;
+					if (!texture || texture->FileName().empty()) continue;
+
+					// Relative paths keep the cache valid when the model folder moves
+					std::filesystem::path texFn = std::filesystem::absolute(texture->FileName());
+					std::filesystem::path rel = texFn.lexically_relative(dir);
+					m.Maps[k] = addString((rel.empty() ? texFn : rel).generic_string());
+				}
+
+				r.Material = matRecords.size();
+				matIds[matName] = r.Material;
+				matRecords.push_back(m);
+			}
+
+			// Offsets
+			CacheHeader header;
+			std::memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+			header.Version = CACHE_VERSION;
+			header.SourceSize = stamp.Size;
+			header.SourceTime = stamp.Time;
+			header.NumMeshes = records.size();
+			header.NumMaterials = matRecords.size();
+			header.StringsOffset = sizeof(CacheHeader) + records.size() * sizeof(CacheMesh) + matRecords.size() * sizeof(CacheMaterial);
+			header.StringsSize = strings.size();
+
+			uint64_t offset = Align(header.StringsOffset + header.StringsSize);
+			for (int i = 0; i < records.size(); i++)
+			{
+				records[i].VertexOffset = offset;
+				offset = Align(offset + records[i].NumVertices * sizeof(geom::Vertex));
+				records[i].IndexOffset = offset;
+				offset = Align(offset + records[i].NumIndices * sizeof(int));
+			}
+
+			// Writes to a temporary file so readers never see a partial cache
+			std::error_code ec;
+			std::filesystem::create_directories(std::filesystem::path(fn).parent_path(), ec);
+			std::string tmpFn = fn + ".tmp";
+			std::ofstream out(tmpFn, std::ios::binary | std::ios::trunc);
+			if (!out.good())
+			{
+				printf("Mesh cache: can not write %s\n", tmpFn.c_str());
+				return false;
+			}
+
+			const char zeros[BLOB_ALIGNMENT] = {};
+			auto pad = [&]()
+			{
+				uint64_t pos = out.tellp();
+				out.write(zeros, Align(pos) - pos);
+			};
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+			out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CacheMesh));
+			out.write(reinterpret_cast<const char*>(matRecords.data()), matRecords.size() * sizeof(CacheMaterial));
+			out.write(strings.data(), strings.size());
+			pad();
+
+			for (int i = 0; i < records.size(); i++)
+			{
+				out.write(reinterpret_cast<const char*>(vertices[i].data()), vertices[i].size() * sizeof(geom::Vertex));
+				pad();
+				out.write(reinterpret_cast<const char*>(indices[i].data()), indices[i].size() * sizeof(int));
+				pad();
+			}
+
+			bool ok = out.good();
+			out.close();
+
+			if (ok) std::filesystem::rename(tmpFn, fn, ec);
+			if (!ok || ec)
+			{
+				printf("Mesh cache: failed to write %s\n", fn.c_str());
+				std::filesystem::remove(tmpFn, ec);
+				return false;
+			}
+
+			return true;
+		}
+
+		bool LoadMeshCache(const std::string& fn, const std::string& modelDir, std::shared_ptr<Scene> xeScene, std::vector<std::shared_ptr<geom::Mesh>>& meshes, const SourceStamp& stamp)
+		{
+			ProfileZone zone("utils::LoadMeshCache");
+
+			// Managers
+			Materials& materials = Materials::Inst();
+			Textures2D& textures = Textures2D::Inst();
+			Names& names = Names::Inst();
+
+			MappedFile file(fn);
+			if (!file.IsOpen() || file.Size() < sizeof(CacheHeader)) return false;
+
+			const unsigned char* data = file.Data();
+			const uint64_t size = file.Size();
+
+			// Checks format and source version
+			CacheHeader header;
+			std::memcpy(&header, data, sizeof(CacheHeader));
+			if (std::memcmp(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.Version != CACHE_VERSION) return false;
+			if (stamp.Size != 0 && (header.SourceSize != stamp.Size || header.SourceTime != stamp.Time)) return false;
+
+			// Checks tables lie inside the file
+			uint64_t tablesEnd = sizeof(CacheHeader) + (uint64_t)header.NumMeshes * sizeof(CacheMesh) + (uint64_t)header.NumMaterials * sizeof(CacheMaterial);
+			if (tablesEnd > header.StringsOffset || !Inside(header.StringsOffset, header.StringsSize, size)) return false;
+
+			const CacheMesh* records = reinterpret_cast<const CacheMesh*>(data + sizeof(CacheHeader));
+			const CacheMaterial* matRecords = reinterpret_cast<const CacheMaterial*>(records + header.NumMeshes);
+			const char* strings = reinterpret_cast<const char*>(data + header.StringsOffset);
+			if (header.StringsSize > 0 && strings[header.StringsSize - 1] != '\0') return false;
+
+			auto getString = [&](const uint32_t& id) { return id < header.StringsSize ? std::string(strings + id) : std::string(); };
+
+			for (uint32_t i = 0; i < header.NumMeshes; i++)
+			{
+				const CacheMesh& r = records[i];
+				bool inside = Inside(r.VertexOffset, (uint64_t)r.NumVertices * sizeof(geom::Vertex), size) && Inside(r.IndexOffset, (uint64_t)r.NumIndices * sizeof(int), size);
+				bool linked = r.Material >= 0 && r.Material < (int32_t)header.NumMaterials && r.Parent < (int32_t)header.NumMeshes;
+				if (!inside || !linked)
+				{
+					printf("Mesh cache: %s is corrupted\n", fn.c_str());
+					return false;
+				}
+			}
+
+			// Texture maps, paths relative to the model
+			std::filesystem::path dir = std::filesystem::absolute(modelDir.empty() ? "." : modelDir).lexically_normal();
+			std::vector<std::map<MapType, std::weak_ptr<Texture2D>>> matMaps(header.NumMaterials);
+
+			for (uint32_t k = 0; k < header.NumMaterials; k++)
+			{
+				for (int t = 0; t < 3; t++)
+				{
+					if (matRecords[k].Maps[t] == NO_ENTRY) continue;
+
+					std::string rel = getString(matRecords[k].Maps[t]);
+					std::string texFn = (dir / rel).lexically_normal().generic_string();
+					matMaps[k][static_cast<MapType>(t)] = textures.Load(texFn, rel);
+				}
+			}
+
+			// Meshes upload straight from the mapping
+			size_t first = meshes.size();
+			for (uint32_t i = 0; i < header.NumMeshes; i++)
+			{
+				const CacheMesh& r = records[i];
+				std::string name = names.Insert(getString(r.Name));
+
+				const geom::Vertex* vertices = reinterpret_cast<const geom::Vertex*>(data + r.VertexOffset);
+				const int* indices = reinterpret_cast<const int*>(data + r.IndexOffset);
+				XM::AABB bounds(r.Bounds[0], r.Bounds[1], r.Bounds[2], r.Bounds[3], r.Bounds[4], r.Bounds[5]);
+				glm::vec3 center(r.Center[0], r.Center[1], r.Center[2]);
+
+				std::shared_ptr<geom::Mesh> mesh = std::make_shared<geom::Mesh>(vertices, r.NumVertices, indices, r.NumIndices, bounds, center, name);
+				mesh->Position(glm::vec3(r.Position[0], r.Position[1], r.Position[2]));
+				mesh->Scale(glm::vec3(r.Scale[0], r.Scale[1], r.Scale[2]));
+				mesh->PYR(glm::vec3(r.PYR[0], r.PYR[1], r.PYR[2]));
+
+				// Material named after the mesh when it had no name of its own
+				const CacheMaterial& m = matRecords[r.Material];
+				std::string matName = m.Name == NO_ENTRY ? name : getString(m.Name);
+				std::shared_ptr<MeshMaterial> material = std::dynamic_pointer_cast<MeshMaterial>(materials.Load(matName, MatType::MeshMat));
+
+				// Cross relation between material and mesh
+				mesh->SetPass(RenderPass::Forward, matName);
+				if (material)
+				{
+					material->MatMaps(matMaps[r.Material]);
+					material->User(mesh);
+				}
+
+				xeScene->Add(mesh);
+				meshes.push_back(mesh);
+			}
+
+			// Set parent-child relations
+			for (uint32_t i = 0; i < header.NumMeshes; i++)
+			{
+				if (records[i].Parent < 0) continue;
+
+				std::shared_ptr<geom::Mesh>& parent = meshes[first + records[i].Parent];
+				meshes[first + i]->Parent(parent);
+				parent->Children(meshes[first + i]);
+			}
+
+			return true;
+		}
+
+	} // namespace utils
+} // namespace X3
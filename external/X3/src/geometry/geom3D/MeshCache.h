@@ -0,0 +1,46 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+// X3
+#include <Scene.h>
+
+// Cross definition
+namespace X3
+{
+	namespace geom
+	{
+		class Mesh;
+	}
+}
+
+namespace X3
+{
+	namespace utils
+	{
+		// Version of a source file, zero when unknown
+		struct SourceStamp
+		{
+			uint64_t Size = 0;
+			int64_t Time = 0;
+		};
+
+		SourceStamp FileStamp(const std::string& fn);
+
+		// Cache file of a model, in Main.CacheDir so source and data trees stay untouched
+		std::string MeshCacheFn(const std::string& fn);
+
+		// Binary mesh cache with processed vertex/index blobs, material maps, names and hierarchy.
+		// Blobs are aligned so a mapped file can be uploaded without intermediate copies. Texture paths
+		// are stored relative to dir, the model directory.
+		bool SaveMeshCache(const std::string& fn, const std::string& dir, const std::vector<std::shared_ptr<geom::Mesh>>& meshes, const SourceStamp& stamp = SourceStamp());
+
+		// Adds cached meshes to the scene. Fails on another format version, or on another stamp when one is given.
+		bool LoadMeshCache(const std::string& fn, const std::string& dir, std::shared_ptr<Scene> xeScene, std::vector<std::shared_ptr<geom::Mesh>>& meshes, const SourceStamp& stamp = SourceStamp());
+
+	} // namespace utils
+} // namespace X3
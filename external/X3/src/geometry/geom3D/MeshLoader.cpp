@@ -1,5 +1,11 @@
+// STL
+#include <filesystem>
+
 // X3
+#include <Parameters.h>
 #include <MeshLoader.h>
+#include <MeshCache.h>
+#include <Profiler.h>
 #include <Mesh.h>
 
 namespace X3
@@ -8,6 +14,20 @@ namespace X3
     {
         std::shared_ptr<geom::Mesh> LoadModel(std::string fName, std::shared_ptr<Scene> xeScene)
         {
+            ProfileZone zone("utils::LoadModel");
+
+            // Processed model is cached outside the data tree
+            bool useCache = Parameters::Inst().Main.MeshCache;
+            std::string cacheName = MeshCacheFn(fName);
+            std::string modelDir = std::filesystem::path(fName).parent_path().string();
+            SourceStamp stamp = FileStamp(fName);
+            std::vector<std::shared_ptr<geom::Mesh>> meshes;
+
+            if (useCache && stamp.Size != 0 && LoadMeshCache(cacheName, modelDir, xeScene, meshes, stamp))
+            {
+                return meshes.size() == 1 ? meshes[0] : nullptr;
+            }
+
             // Assimp loader
             Assimp::Importer import;
             const aiScene * scene = import.ReadFile(fName, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
@@ -33,16 +53,21 @@ namespace X3
 
                 // Send to XE scene
                 xeScene->Add(xeMesh);
-
-                return xeMesh;
+                meshes.push_back(xeMesh);
             }
             // Multiple objects, load iteratively
             else
             {
-                ProcessNode(directory, scene->mRootNode, scene, xeScene, nullptr);
+                ProcessNode(directory, scene->mRootNode, scene, xeScene, nullptr, meshes);
+            }
+
+            // Next load skips the import
+            if (useCache && stamp.Size != 0 && !SaveMeshCache(cacheName, modelDir, meshes, stamp))
+            {
+                std::cout << "WARNING: could not cache " << fName << std::endl;
             }
 
-            return nullptr;
+            return meshes.size() == 1 ? meshes[0] : nullptr;
 
         }
 
@@ -78,8 +103,10 @@ namespace X3
             return matMaps;
         }
 
-        void ProcessNode(const std::string& dir, aiNode* node, const aiScene* scene, std::shared_ptr<Scene> xeScene, std::shared_ptr<Renderable> meshNode)
+        void ProcessNode(const std::string& dir, aiNode* node, const aiScene* scene, std::shared_ptr<Scene> xeScene, std::shared_ptr<Renderable> meshNode, std::vector<std::shared_ptr<geom::Mesh>>& meshes)
         {
+            // First mesh of the node carries its children, nodes without meshes pass their parent on
+            std::shared_ptr<Renderable> childParent = meshNode;
 
             // Process meshes in this node
             if (node->mNumMeshes > 0)
@@ -93,6 +120,7 @@ namespace X3
 
                     // Send to X3 scene
                     xeScene->Add(xeMesh);
+                    meshes.push_back(xeMesh);
 
                     // Set parent-child relations
                     if (meshNode)
@@ -100,13 +128,15 @@ namespace X3
                         xeMesh->Parent(meshNode);
                         meshNode->Children(xeMesh);
                     }
+
+                    if (meshIdx == 0) childParent = xeMesh;
                 }
             }
 
             // Process children nodes
             for (int i = 0; i < node->mNumChildren; i++)
             {
-                ProcessNode(dir, node->mChildren[i], scene, xeScene, nullptr);
+                ProcessNode(dir, node->mChildren[i], scene, xeScene, childParent, meshes);
             }
         }
 
@@ -116,14 +146,15 @@ namespace X3
             Materials& materials = Materials::Inst();
             Names& names = Names::Inst();
 
-            // Prepares containers
-            std::vector<geom::Vertex> vertices;
+            // Prepares containers, faces are triangles after aiProcess_Triangulate
+            std::vector<geom::Vertex> vertices(mesh->mNumVertices);
             std::vector<int> indices;
+            indices.reserve(3 * mesh->mNumFaces);
 
             // Process vertices
             for (int i = 0; i < mesh->mNumVertices; i++)
             {
-                geom::Vertex vertex;
+                geom::Vertex& vertex = vertices[i];
 
                 vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
                 vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
@@ -137,14 +168,12 @@ namespace X3
                 {
                     vertex.TexCoord = glm::vec2(0.f);
                 }
-
-                vertices.push_back(vertex);
             }
 
             // Process indices
             for (int i = 0; i < mesh->mNumFaces; i++)
             {
-                aiFace face = mesh->mFaces[i];
+                const aiFace& face = mesh->mFaces[i];
                 for (int j = 0; j < face.mNumIndices; j++)
                 {
                     indices.push_back(face.mIndices[j]);
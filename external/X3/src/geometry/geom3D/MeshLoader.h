@@ -28,7 +28,7 @@ namespace X3
 		// Assimp Helpers
 		void LoadMatMap(const std::string& dir, aiMaterial* mat, std::map<MapType, std::weak_ptr<Texture2D>>& map, aiTextureType aiType, MapType type);
 		std::map<MapType, std::weak_ptr<Texture2D>> LoadMatMaps(const std::string& dir, aiMaterial* mat);
-		void ProcessNode(const std::string& dir, aiNode* node, const aiScene* scene, std::shared_ptr<Scene> xeScene, std::shared_ptr<Renderable> meshNode);
+		void ProcessNode(const std::string& dir, aiNode* node, const aiScene* scene, std::shared_ptr<Scene> xeScene, std::shared_ptr<Renderable> meshNode, std::vector<std::shared_ptr<geom::Mesh>>& meshes);
 		std::shared_ptr<X3::geom::Mesh> ProcessMesh(const std::string& dir, aiMesh* mesh, const aiScene* scene, const std::string& name = "");
 
 	} // namespace utils
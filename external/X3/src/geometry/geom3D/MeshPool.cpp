@@ -0,0 +1,131 @@
+// X3
+#include <MeshPool.h>
+#include <Mesh.h>
+
+namespace X3
+{
+	namespace geom
+	{
+		// First fit in the free list, otherwise grows the end
+		static int AllocateBlock(std::map<int, int>& freeList, int& end, const int& size)
+		{
+			for (auto it = freeList.begin(); it != freeList.end(); ++it)
+			{
+				if (it->second < size) continue;
+
+				int offset = it->first;
+				int remaining = it->second - size;
+				freeList.erase(it);
+				if (remaining > 0) freeList[offset + size] = remaining;
+				return offset;
+			}
+
+			int offset = end;
+			end += size;
+			return offset;
+		}
+
+		// Returns a block merging it with its free neighbours
+		static void FreeBlock(std::map<int, int>& freeList, int& end, int offset, int size)
+		{
+			if (size == 0) return;
+
+			auto next = freeList.lower_bound(offset);
+			if (next != freeList.end() && offset + size == next->first)
+			{
+				size += next->second;
+				next = freeList.erase(next);
+			}
+
+			if (next != freeList.begin())
+			{
+				auto prev = std::prev(next);
+				if (prev->first + prev->second == offset)
+				{
+					offset = prev->first;
+					size += prev->second;
+					freeList.erase(prev);
+				}
+			}
+
+			// Trailing blocks shrink the used storage
+			if (offset + size == end) end = offset;
+			else freeList[offset] = size;
+		}
+
+		MeshPool& MeshPool::Inst()
+		{
+			static MeshPool pool;
+			return pool;
+		}
+
+		MeshPool::MeshPool()
+		{
+			// Init render data
+			mEbo = std::make_shared<Vbo<int>>(std::vector<int>{}, GL_STATIC_DRAW, GL_ELEMENT_ARRAY_BUFFER);
+			mVbo = std::make_shared<Vbo<Vertex>>(std::vector<Vertex>{}, GL_STATIC_DRAW);
+
+			mVao = std::make_shared<Vao>(std::vector<VertexAttrib>{
+				VertexAttrib(mVbo, 0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0),
+				VertexAttrib(mVbo, 1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, Normal))),
+				VertexAttrib(mVbo, 2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, TexCoord)))
+			});
+
+			mVao->BindEbo(mEbo);
+		}
+
+		std::shared_ptr<MeshRange> MeshPool::Allocate(const std::vector<Vertex>& vertices, const std::vector<int>& indices)
+		{
+			return Allocate(vertices.data(), vertices.size(), indices.data(), indices.size());
+		}
+
+		std::shared_ptr<MeshRange> MeshPool::Allocate(const Vertex* vertices, const int& numVertices, const int* indices, const int& numIndices)
+		{
+			MeshRange range;
+			range.NumVertices = numVertices;
+			range.NumIndices = numIndices;
+			range.BaseVertex = AllocateBlock(mFreeVertices, mEndVertex, range.NumVertices);
+			range.FirstIndex = AllocateBlock(mFreeIndices, mEndIndex, range.NumIndices);
+
+			// Indices stay local to the mesh, draws add the base vertex
+			Reserve(mEndVertex, mEndIndex);
+			if (range.NumVertices > 0) mVbo->AddSubData(vertices, range.BaseVertex, range.NumVertices);
+			if (range.NumIndices > 0) mEbo->AddSubData(indices, range.FirstIndex, range.NumIndices);
+
+			return std::shared_ptr<MeshRange>(new MeshRange(range), [](MeshRange* r)
+			{
+				MeshPool::Inst().Free(*r);
+				delete r;
+			});
+		}
+
+		void MeshPool::Read(const MeshRange& range, std::vector<Vertex>& vertices, std::vector<int>& indices)
+		{
+			vertices.resize(range.NumVertices);
+			indices.resize(range.NumIndices);
+
+			if (range.NumVertices > 0) mVbo->GetSubData(vertices.data(), range.BaseVertex, range.NumVertices);
+			if (range.NumIndices > 0) mEbo->GetSubData(indices.data(), range.FirstIndex, range.NumIndices);
+		}
+
+		void MeshPool::Free(const MeshRange& range)
+		{
+			FreeBlock(mFreeVertices, mEndVertex, range.BaseVertex, range.NumVertices);
+			FreeBlock(mFreeIndices, mEndIndex, range.FirstIndex, range.NumIndices);
+		}
+
+		void MeshPool::Reserve(const int& numVertices, const int& numIndices)
+		{
+			bool grow = numVertices > mVbo->NumElements() || numIndices > mEbo->NumElements();
+			if (!grow) return;
+
+			// Doubles capacity so appends stay amortized
+			if (numVertices > mVbo->NumElements()) mVbo->Reserve(std::max(numVertices, 2 * mVbo->NumElements()));
+			if (numIndices > mEbo->NumElements()) mEbo->Reserve(std::max(numIndices, 2 * mEbo->NumElements()));
+
+			// Buffer names changed, point the vertex array to the new ones
+			mVao->UpdateVertAttribPointers();
+			mVao->BindEbo(mEbo);
+		}
+	} // namespace geom
+} // namespace X3
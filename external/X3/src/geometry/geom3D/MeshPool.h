@@ -0,0 +1,74 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <memory>
+#include <map>
+
+// GL
+#include <glad/glad.h>
+
+// X3
+#include <Vao.h>
+#include <Vbo.h>
+
+namespace X3
+{
+	namespace geom
+	{
+		// Cross-definition
+		struct Vertex;
+
+		// Slice of the pool owned by one or more meshes
+		struct MeshRange
+		{
+			int BaseVertex = 0;
+			int NumVertices = 0;
+			int FirstIndex = 0;
+			int NumIndices = 0;
+		};
+
+		// Singleton vertex/index storage shared by all meshes, so meshes of
+		// different geometry can be drawn from one vertex array
+		class MeshPool
+		{
+		public:
+
+			// Gets the one and only instance of the mesh pool
+			static MeshPool& Inst();
+
+			// Copies geometry into the pool. The range is released with its last owner.
+			std::shared_ptr<MeshRange> Allocate(const std::vector<Vertex>& vertices, const std::vector<int>& indices);
+			std::shared_ptr<MeshRange> Allocate(const Vertex* vertices, const int& numVertices, const int* indices, const int& numIndices);
+
+			// Reads a range back from the GPU
+			void Read(const MeshRange& range, std::vector<Vertex>& vertices, std::vector<int>& indices);
+
+			// Get/Set
+			std::shared_ptr<Vao>& GetVao() { return mVao; }
+			int NumVertices() { return mEndVertex; }
+			int NumIndices() { return mEndIndex; }
+
+		private:
+
+			// Render data
+			std::shared_ptr<Vbo<Vertex>> mVbo;
+			std::shared_ptr<Vbo<int>> mEbo;
+			std::shared_ptr<Vao> mVao;
+
+			// Free blocks (offset -> size) and end of used storage
+			std::map<int, int> mFreeVertices;
+			std::map<int, int> mFreeIndices;
+			int mEndVertex = 0;
+			int mEndIndex = 0;
+
+			// Helpers
+			MeshPool(); // Private constructor to make class singleton
+			MeshPool(const MeshPool&) = delete; // No copy constructor allowed
+			void operator=(const MeshPool&) = delete; // No copy assignment allowed
+
+			void Free(const MeshRange& range);
+			void Reserve(const int& numVertices, const int& numIndices);
+		};
+	} // namespace geom
+} // namespace X3
@@ -8,26 +8,64 @@ namespace X3
 		{
 
 			// Set data
-			mColors.assign(positions.size(), color);
-			mPositions = positions;
+			mDataSize = positions.size();
 			mPrimitive = GL_POINTS;
+			mColor = color;
 			mName = name;
 
 			// Init OpenGL buffers
-			SetupBuffers();
+			SetupBuffers(positions);
+			UpdateAttribs();
 
 		}
 
 		GLuint Points::GetVbo()
 		{
+			if (mStreamPos) return 0;
 			return mVboPos->GetID();
 		}
 
+		void Points::Positions(const std::vector<glm::vec3>& positions)
+		{
+			bool resized = positions.size() != mDataSize;
+			mDataSize = positions.size();
+
+			// Streamed from now on, the plain buffer is released
+			if (!mStreamPos) mStreamPos = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, mDataSize * sizeof(glm::vec3));
+			mVboPos = nullptr;
+			mOffsetPos = mStreamPos->Write(positions);
+
+			if (resized) Colors(std::vector<glm::vec3>(mDataSize, mColor));
+			else UpdateAttribs();
+		}
+
+		void Points::Colors(const std::vector<glm::vec3>& colors)
+		{
+			if (colors.size() != mDataSize)
+			{
+				printf("Points: %s expects %i colors\n", mName.c_str(), mDataSize);
+				return;
+			}
+
+			if (!mStreamColor) mStreamColor = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, mDataSize * sizeof(glm::vec3));
+			mVboColor = nullptr;
+			mOffsetColor = mStreamColor->Write(colors);
+			UpdateAttribs();
+		}
+
 		void Points::Render()
 		{
 			mVao->Bind();
-			glDrawArrays(mPrimitive, 0, mPositions.size());
-			mVao->Unbind();
+			glDrawArrays(mPrimitive, 0, mDataSize);
+		}
+
+		BatchGeometry Points::Geometry()
+		{
+			BatchGeometry geometry;
+			geometry.Vao = mVao->GetID();
+			geometry.Primitive = mPrimitive;
+			geometry.Count = mDataSize;
+			return geometry;
 		}
 
 		void Points::RenderUi()
@@ -37,16 +75,24 @@ namespace X3
 			ImGui::End();
 		}
 
-		void Points::SetupBuffers()
+		void Points::SetupBuffers(const std::vector<glm::vec3>& positions)
 		{
-			// Init render data
-			mVboPos = std::make_shared<Vbo<glm::vec3>>(mPositions, GL_DYNAMIC_DRAW);
-			mVboColor = std::make_shared<Vbo<glm::vec3>>(mColors, GL_DYNAMIC_DRAW);
+			// Init render data, positions may be written by interop
+			mVboPos = std::make_shared<Vbo<glm::vec3>>(positions, GL_DYNAMIC_DRAW);
+			mVboColor = std::make_shared<Vbo<glm::vec3>>(std::vector<glm::vec3>(mDataSize, mColor));
+			mVao = std::make_shared<Vao>();
+		}
 
-			mVao = std::make_shared<Vao>(std::vector<VertexAttrib>{
-				VertexAttrib(mVboPos, 0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0),
-				VertexAttrib(mVboColor, 1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0)
+		void Points::UpdateAttribs()
+		{
+			// Each write moves streamed data within the rings
+			std::shared_ptr<GLBufferBase> pos = mStreamPos ? std::static_pointer_cast<GLBufferBase>(mStreamPos) : mVboPos;
+			std::shared_ptr<GLBufferBase> color = mStreamColor ? std::static_pointer_cast<GLBufferBase>(mStreamColor) : mVboColor;
+			mVao->AddAttribs(std::vector<VertexAttrib>{
+				VertexAttrib(pos, 0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(mStreamPos ? mOffsetPos : 0)),
+				VertexAttrib(color, 1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)(mStreamColor ? mOffsetColor : 0))
 			});
+			mVao->UpdateVertAttribPointers();
 		}
 	}
 }
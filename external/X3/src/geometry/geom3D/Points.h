@@ -9,6 +9,7 @@
 // X3
 #include <Renderable.h>
 #include <Materials.h>
+#include <StreamBuffer.h>
 #include <Textures.h>
 #include <Vao.h>
 #include <Vbo.h>
@@ -29,22 +30,37 @@ namespace X3
 			void Render() override;
 			void RenderUi() override;
 
-			int NumPoints() const { return static_cast<int>(mPositions.size()); }
+			// Streams new data without reallocating, a new count resets colors to the base color.
+			// Updated data moves to ring buffers, for point clouds rewritten every frame
+			void Positions(const std::vector<glm::vec3>& positions);
+			void Colors(const std::vector<glm::vec3>& colors);
 
+			int NumPoints() const { return mDataSize; }
+
+			// Batching (own buffers for interop, one indirect command each)
+			bool Batchable() override { return true; }
+			BatchGeometry Geometry() override;
+
+			// Positions given at construction, from offset 0. Streamed positions move every update
+			// and have no fixed buffer, 0 is returned then
 			GLuint GetVbo() override;
 
 		protected:
 
 			// Points data
-			std::vector<glm::vec3> mPositions;
-			std::vector<glm::vec3> mColors;
+			glm::vec3 mColor;
 
-			// Render data
-			std::shared_ptr<Vbo<glm::vec3>> mVboPos, mVboColor;
+			// Render data. Data given at construction stays in plain buffers, updated data is
+			// streamed through rings created on first update, starting at the offsets
+			std::shared_ptr<Vbo<glm::vec3>> mVboPos;
+			std::shared_ptr<Vbo<glm::vec3>> mVboColor;
+			std::shared_ptr<StreamBuffer> mStreamPos, mStreamColor;
+			GLintptr mOffsetPos = 0, mOffsetColor = 0;
 			std::shared_ptr<Vao> mVao;
 
 			// Helpers
-			void SetupBuffers();
+			void SetupBuffers(const std::vector<glm::vec3>& positions);
+			void UpdateAttribs();
 		};
 
 	} // namespace geom
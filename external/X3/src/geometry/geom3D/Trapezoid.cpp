@@ -86,7 +86,8 @@ namespace X3
 				if (vertex.z > maxZ) maxZ = vertex.z;
 			}
 
-			mBoundingBox = XM::AABB(minX, maxX, minY, maxY, minZ, maxZ);
+			BoundingBox(XM::AABB(minX, maxX, minY, maxY, minZ, maxZ));
+			mCullable = true;
 		}
 
 		void Trapezoid::SetupBuffers()
@@ -16,7 +16,7 @@ namespace X3
         mAttenuation = glm::vec3(1.f, 0.09f, 0.032f);
         mConeAngle = glm::vec2(12.5f, 17.5f);
         mViewDir = dir;
-        mPosition = p;
+        Position(p);
 
 
         // Prepares render data
@@ -114,7 +114,7 @@ namespace X3
             shade->Unif("lightColor") = mColor;
             shade->Unif("intensity") = mIntensity;
             glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, mPosition);
+            model = glm::translate(model, Position());
             model = glm::scale(model, glm::vec3(0.2));
             shade->Unif("model") = model;
             mVao->Bind();
@@ -133,7 +133,8 @@ namespace X3
     void Light::RenderUi()
     {
         ImGui::Text("Name: %s", mName.c_str());
-        ImGui::SliderFloat3("Position", &mPosition.x, -2.0f, 2.0f, "%.5f");
+        glm::vec3 position = Position();
+        if (ImGui::SliderFloat3("Position", &position.x, -2.0f, 2.0f, "%.5f")) Position(position);
         ImGui::SliderFloat3("Direction", &mViewDir.x, -1.0f, 1.0f, "%.5f");
         ImGui::ColorEdit3("Color", &mColor.x);
         ImGui::SliderFloat("Cone inner", &mConeAngle.x, 0.f, 90.f, "%.5f");
@@ -150,7 +151,7 @@ namespace X3
         UboLight params;
 
         params.Attenuation = mAttenuation;
-        params.Position = mPosition;
+        params.Position = Position();
         params.ViewDir = mViewDir;
         params.Intensity = mIntensity;
         params.ConeAngleCos = ConeAngleCos();
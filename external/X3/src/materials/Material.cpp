@@ -1,28 +1,74 @@
+// STL
+#include <algorithm>
+
 // X3
 #include <Renderable.h>
 #include <STLUtils.h>
 #include <Material.h>
+#include <Profiler.h>
 #include <Camera.h>
 #include <Light.h>
 
 namespace X3
 {
+	// Uniform names hashed at compile time
+	static constexpr UniformId UNIF_MODEL("model");
+	static constexpr UniformId UNIF_HAS_DIFFUSE("material.HasMaterial[0]");
+	static constexpr UniformId UNIF_HAS_SPECULAR("material.HasMaterial[1]");
+	static constexpr UniformId UNIF_HAS_EMISSION("material.HasMaterial[2]");
+	static constexpr UniformId UNIF_DIFFUSE("material.diffuse");
+	static constexpr UniformId UNIF_SPECULAR("material.specular");
+	static constexpr UniformId UNIF_EMISSION("material.emission");
+	static constexpr UniformId UNIF_SHININESS("material.shininess");
+	static constexpr UniformId UNIF_COLOR("material.Color");
+
 	void Material::Update()
 	{
 		// Erase expired users
 		utils::EraseExpiredPointers(mUsers);
 	}
 
+	void Material::User(std::shared_ptr<Renderable> user)
+	{
+		// Cross relation so culling can reach the material from the object
+		mUsers.push_back(user);
+		user->FwdMaterial(shared_from_this());
+	}
+
+	InstanceData Material::Instance(Renderable* user)
+	{
+		return { user->MatM(), glm::vec4(1.f), glm::vec4(0.f) };
+	}
+
+	void Material::Batch(Batcher& batcher)
+	{
+		if (!Batchable()) return;
+
+		// Users without shareable geometry stay for the regular path
+		auto it = std::remove_if(mVisibleUsers.begin(), mVisibleUsers.end(), [&](Renderable* user)
+		{
+			if (!user->Batchable()) return false;
+			batcher.Add(user->Geometry(), Instance(user));
+			return true;
+		});
+
+		mVisibleUsers.erase(it, mVisibleUsers.end());
+	}
+
 	void Material::RenderUsers(std::shared_ptr<Shader>& shader)
 	{
-		// Render all objects associated to this material
-		for (int i = 0; i < mUsers.size(); i++)
+		Profiler& profiler = Profiler::Inst();
+
+		// Render objects of this material that survived culling
+		for (auto user : mVisibleUsers)
 		{
-			auto lockedUser = mUsers[i].lock();
-			if(lockedUser->Visible())
+			shader->Unif(UNIF_MODEL) = user->MatM();
+			user->Render();
+
+			if (profiler.Enabled())
 			{
-				shader->Unif("model") = lockedUser->MatM();
-				lockedUser->Render();
+				BatchGeometry geometry = user->Geometry();
+				profiler.CountDraw(geometry.Primitive, geometry.Count);
 			}
 		}
 	}
@@ -49,25 +95,30 @@ namespace X3
 		Parameters& params = Parameters::Inst();
 
 		// Binds available materials/textures
-		shader->Unif("material.HasMaterial[0]") = mHasMaterial[0];
-		shader->Unif("material.HasMaterial[1]") = mHasMaterial[1];
-		shader->Unif("material.HasMaterial[2]") = mHasMaterial[2];
+		shader->Unif(UNIF_HAS_DIFFUSE) = mHasMaterial[0];
+		shader->Unif(UNIF_HAS_SPECULAR) = mHasMaterial[1];
+		shader->Unif(UNIF_HAS_EMISSION) = mHasMaterial[2];
 
 		int texCounter = 0;
 		for (const auto& pair : mMatMaps) pair.second.lock()->Bind(GL_TEXTURE0 + texCounter++);
 
 		// Set other material properties
-		shader->Unif("material.diffuse") = 0;
-		shader->Unif("material.specular") = 1;
-		shader->Unif("material.emission") = 2;
-		shader->Unif("material.shininess") = mShininess;
-		shader->Unif("material.Color") = mColor;
+		shader->Unif(UNIF_DIFFUSE) = 0;
+		shader->Unif(UNIF_SPECULAR) = 1;
+		shader->Unif(UNIF_EMISSION) = 2;
+		shader->Unif(UNIF_SHININESS) = mShininess;
+		shader->Unif(UNIF_COLOR) = mColor;
 
 		// Render all objects associated to this material
 		RenderUsers(shader);
 
 	}
 
+	InstanceData MeshMaterial::Instance(Renderable* user)
+	{
+		return { user->MatM(), mColor, glm::vec4(mShininess, 0.f, 0.f, 0.f) };
+	}
+
 	void MeshMaterial::MatMaps(std::map<MapType, std::weak_ptr<Texture2D>>& matMaps)
 	{
 		mMatMaps = matMaps;
@@ -127,6 +178,11 @@ namespace X3
 		RenderUsers(shader);
 	}
 
+	InstanceData PointMaterial::Instance(Renderable* user)
+	{
+		return { user->MatM(), glm::vec4(1.f), glm::vec4(mRadius, 0.f, 0.f, 0.f) };
+	}
+
 	BoxMaterial::BoxMaterial(const std::string& name)
 	{
 		mColor = glm::vec3(0.f, 0.f, 1.f);
@@ -143,6 +199,11 @@ namespace X3
 		RenderUsers(shader);
 	}
 
+	InstanceData BoxMaterial::Instance(Renderable* user)
+	{
+		return { user->MatM(), glm::vec4(mColor, 1.f), glm::vec4(0.f) };
+	}
+
     GridMaterial::GridMaterial(const std::string &name)
     {
 		mName = name;
@@ -9,6 +9,7 @@
 // X3
 #include <Textures.h>
 #include <Shaders.h>
+#include <Batcher.h>
 
 
 namespace X3
@@ -23,7 +24,7 @@ namespace X3
 	enum class MapType { Diffuse, Specular, Emission };
 
 	// General material
-	class Material
+	class Material : public std::enable_shared_from_this<Material>
 	{
 	public:
 
@@ -33,10 +34,24 @@ namespace X3
 
 		virtual void Render(std::shared_ptr<Shader>&& shader) {}
 
+		// Batching: moves visible users with shared geometry to the batcher
+		virtual bool Batchable() { return false; }
+		virtual InstanceData Instance(Renderable* user);
+		void Batch(Batcher& batcher);
+
 		// Get/Set
-		void User(std::shared_ptr<Renderable> user) { mUsers.push_back(user); }
+		void User(std::shared_ptr<Renderable> user);
 		int NumUsers() { return mUsers.size(); }
 
+		// Users that passed culling for the viewport being rendered
+		void VisibleUser(Renderable* user) { mVisibleUsers.push_back(user); }
+		void ClearVisibleUsers() { mVisibleUsers.clear(); }
+		int NumVisibleUsers() { return mVisibleUsers.size(); }
+
+		// Shader drawing this material, set when the material is added to it
+		void Owner(Shader* shader) { mOwner = shader; }
+		Shader* Owner() { return mOwner; }
+
 		// Set a variable of any type
 		template<typename T>
 		void Set(const std::string& name, T value) 
@@ -60,6 +75,8 @@ namespace X3
 
 		// Material data
 		std::vector<std::weak_ptr<Renderable>> mUsers;
+		std::vector<Renderable*> mVisibleUsers;
+		Shader* mOwner = nullptr;
 		std::map<std::string, std::any> mVariables;
 		std::string mName;
 
@@ -78,8 +95,13 @@ namespace X3
 		MeshMaterial(const std::string& name);
 		void Render(std::shared_ptr<Shader>&& shader) override;
 
+		// Textured materials keep the regular path
+		bool Batchable() override { return mMatMaps.empty(); }
+		InstanceData Instance(Renderable* user) override;
+
 		// Get/Set
 		void MatMaps(std::map<MapType, std::weak_ptr<Texture2D>>& matMaps);
+		std::map<MapType, std::weak_ptr<Texture2D>>& MatMaps() { return mMatMaps; }
 
 	private:
 
@@ -123,6 +145,9 @@ namespace X3
 		PointMaterial(const std::string& name);
 		void Render(std::shared_ptr<Shader>&& shader) override;
 
+		bool Batchable() override { return true; }
+		InstanceData Instance(Renderable* user) override;
+
 	private:
 		float mRadius;
 	};
@@ -134,6 +159,9 @@ namespace X3
 		// Common methods
 		BoxMaterial(const std::string& name);
 		void Render(std::shared_ptr<Shader>&& shader) override;
+
+		bool Batchable() override { return true; }
+		InstanceData Instance(Renderable* user) override;
 	private:
 		glm::vec3 mColor;
 	};
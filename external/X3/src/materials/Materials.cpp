@@ -1,4 +1,5 @@
 #include <Materials.h>
+#include <Profiler.h>
 
 namespace X3
 {
@@ -19,60 +20,46 @@ namespace X3
         }
 
         // Generate new material
-        Shaders& shaders = Shaders::Inst();
-        std::string rootDir = Parameters::Inst().Main.RootDir;
-
-        std::shared_ptr<Shader> shader = nullptr;
-
-        // Loads corresponding material and shader pair
         switch (type)
         {
         case MatType::MeshMat:
         {
             mMatCache[key] = std::make_shared<MeshMaterial>(key);
-            shader = shaders.Load("MeshFw", rootDir + "/shaders/objects/MeshFw");
             break;
         }
         case MatType::DepthMat:
         {
             mMatCache[key] = std::make_shared<DepthMaterial>(key);
-            shader = shaders.Load("DepthBuffer", rootDir + "/shaders/objects/DepthBuffer");
             break;
         }
         case MatType::SolidMat:
         {
             mMatCache[key] = std::make_shared<SolidMaterial>(key);
-            shader = shaders.Load("SolidColor", rootDir + "/shaders/objects/SolidColor");
             break;
         }
         case MatType::BoxMat:
         {
             mMatCache[key] = std::make_shared<BoxMaterial>(key);
-            shader = shaders.Load("Box", rootDir + "/shaders/objects/Box");
             break;
         }
         case MatType::PointMat:
         {
             mMatCache[key] = std::make_shared<PointMaterial>(key);
-            shader = shaders.Load("Points", { rootDir + "/shaders/objects/Points.vert",  rootDir + "/shaders/objects/Points.geom", rootDir + "/shaders/objects/Points.frag" });
             break;
         }
         case MatType::Point2DMat:
         {
             mMatCache[key] = std::make_shared<PointMaterial>(key);
-            shader = shaders.Load("Points2D", { rootDir + "/shaders/objects/Points2D.vert",  rootDir + "/shaders/objects/Points2D.geom", rootDir + "/shaders/objects/Points2D.frag" });
             break;
         }
         case MatType::Grid1DMat:
         {
             mMatCache[key] = std::make_shared<GridMaterial>(key);
-            shader = shaders.Load("Grid1D", rootDir + "/shaders/objects/Grid1D");
             break;
         }
         case MatType::Grid2DMat:
         {
             mMatCache[key] = std::make_shared<GridMaterial>(key);
-            shader = shaders.Load("Grid2D", rootDir + "/shaders/objects/Grid2D");
             break;
         }
         // case MatType::Grid3DMat:
@@ -90,19 +77,16 @@ namespace X3
         case MatType::Curve2DMat:
         {
             mMatCache[key] = std::make_shared<SurfaceMaterial>(key);
-            shader = shaders.Load("Curve2D", rootDir + "/shaders/objects/Curve2D");
             break;
         }
         case MatType::Shallow2DMat:
         {
             mMatCache[key] = std::make_shared<Shallow2DMaterial>(key);
-            shader = shaders.Load("Shallow2D", rootDir + "/shaders/objects/Shallow2D");
             break;
         }
         case MatType::Potential2DMat:
         {
             mMatCache[key] = std::make_shared<Potential2DMaterial>(key);
-            shader = shaders.Load("Potential2D", { rootDir + "/shaders/objects/Potential2D.vert", rootDir + "/shaders/objects/Potential2D.frag" });
             break;
         }
         default:
@@ -110,12 +94,46 @@ namespace X3
         }
 
         // Shader-material relation
-        shader->AddMaterial(mMatCache[key]);
+        std::shared_ptr<Shader> shader = LoadShader(type);
+        if (shader) shader->AddMaterial(mMatCache[key]);
 
         return mMatCache[key];
 
     }
 
+    std::shared_ptr<Shader> Materials::LoadShader(MatType type)
+    {
+        Shaders& shaders = Shaders::Inst();
+        std::string rootDir = Parameters::Inst().Main.RootDir;
+
+        switch (type)
+        {
+        case MatType::MeshMat: return shaders.Load("MeshFw", rootDir + "/shaders/objects/MeshFw");
+        case MatType::DepthMat: return shaders.Load("DepthBuffer", rootDir + "/shaders/objects/DepthBuffer");
+        case MatType::SolidMat: return shaders.Load("SolidColor", rootDir + "/shaders/objects/SolidColor");
+        case MatType::BoxMat: return shaders.Load("Box", rootDir + "/shaders/objects/Box");
+        case MatType::PointMat: return shaders.Load("Points", { rootDir + "/shaders/objects/Points.vert",  rootDir + "/shaders/objects/Points.geom", rootDir + "/shaders/objects/Points.frag" });
+        case MatType::Point2DMat: return shaders.Load("Points2D", { rootDir + "/shaders/objects/Points2D.vert",  rootDir + "/shaders/objects/Points2D.geom", rootDir + "/shaders/objects/Points2D.frag" });
+        case MatType::Grid1DMat: return shaders.Load("Grid1D", rootDir + "/shaders/objects/Grid1D");
+        case MatType::Grid2DMat: return shaders.Load("Grid2D", rootDir + "/shaders/objects/Grid2D");
+        case MatType::Curve2DMat: return shaders.Load("Curve2D", rootDir + "/shaders/objects/Curve2D");
+        case MatType::Shallow2DMat: return shaders.Load("Shallow2D", rootDir + "/shaders/objects/Shallow2D");
+        case MatType::Potential2DMat: return shaders.Load("Potential2D", { rootDir + "/shaders/objects/Potential2D.vert", rootDir + "/shaders/objects/Potential2D.frag" });
+        default: return nullptr;
+        }
+    }
+
+    void Materials::LoadShaders()
+    {
+        ProfileZone zone("Materials::LoadShaders");
+
+        // Compiler threads are set before the first build, some drivers stay serial otherwise
+        Shaders::Inst().ParallelCompile();
+
+        // Programs are built by the driver while the scene loads, and finished on first use
+        for (int type = 0; type < (int)MatType::EmptyMat; type++) LoadShader((MatType)type);
+    }
+
     std::shared_ptr<Material> Materials::GetMaterial(const std::string& key) const
     {
         if (!ContainsMaterial(key))
@@ -129,6 +147,8 @@ namespace X3
 
     void Materials::Update()
     {
+        ProfileZone zone("Materials::Update");
+
         // Update all materials in cache
         for (auto& mat : mMatCache) mat.second->Update();
 
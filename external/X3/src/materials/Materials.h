@@ -24,6 +24,9 @@ namespace X3
 		void ClearCache();
 		void Update();
 
+		// Starts building the programs of all material types, so none compiles on first draw
+		void LoadShaders();
+
 		// Get/Set
 		std::map<std::string, std::shared_ptr<Material>>& MatCache() { return mMatCache; }
 		std::shared_ptr<Material> GetMaterial(const std::string& key) const;
@@ -40,5 +43,6 @@ namespace X3
 		void operator=(const Materials&) = delete; // No copy assignment allowed
 
 		bool ContainsMaterial(const std::string& key) const;
+		std::shared_ptr<Shader> LoadShader(MatType type);
 	};
 } // namespace X3
\ No newline at end of file
@@ -0,0 +1,115 @@
+// STL
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+// X3
+#include <Profiler.h>
+#include <GLState.h>
+#include <Batcher.h>
+
+namespace X3
+{
+	// Instance buffer binding point, see shaders/ubo/instances.glsl
+	static const GLuint INSTANCES_BINDING = 6;
+
+	Batcher::Batcher() : mSsboInstances(GL_SHADER_STORAGE_BUFFER), mIndirect(GL_DRAW_INDIRECT_BUFFER)
+	{
+	}
+
+	void Batcher::Add(const BatchGeometry& geometry, const InstanceData& data)
+	{
+		mItems.push_back({ geometry, data });
+	}
+
+	void Batcher::Render()
+	{
+		mNumDrawCalls = 0;
+		if (mItems.empty()) return;
+
+		// Sort and merge frame objects
+		BuildCommands();
+
+		// Upload frame data
+		GLintptr instances = mSsboInstances.Write(mInstances);
+		GLintptr commands = mIndirect.Write(mCommands);
+
+		mSsboInstances.BindBufferRange(INSTANCES_BINDING, instances, mInstances.size() * sizeof(InstanceData));
+		mIndirect.Bind();
+
+		// One call per vertex array
+		for (const Group& group : mGroups)
+		{
+			const void* offset = (const void*)(commands + group.FirstCommand * sizeof(DrawCommand));
+
+			GLState::Inst().BindVertexArray(group.Vao);
+			if (group.Indexed) glMultiDrawElementsIndirect(group.Primitive, GL_UNSIGNED_INT, offset, group.NumCommands, sizeof(DrawCommand));
+			else glMultiDrawArraysIndirect(group.Primitive, offset, group.NumCommands, sizeof(DrawCommand));
+		}
+
+		mIndirect.Unbind();
+
+		// Issued calls, and the triangles and instances they expand to
+		Profiler& profiler = Profiler::Inst();
+		if (profiler.Enabled())
+		{
+			profiler.Count(Counter::DrawCalls, mGroups.size());
+			for (const Group& group : mGroups)
+			{
+				for (int i = group.FirstCommand; i < group.FirstCommand + group.NumCommands; i++)
+				{
+					const DrawCommand& c = mCommands[i];
+					profiler.Count(Counter::Triangles, Profiler::Triangles(group.Primitive, c.Count) * c.InstanceCount);
+					profiler.Count(Counter::Instances, c.InstanceCount);
+				}
+			}
+		}
+
+		mNumDrawCalls = mGroups.size();
+		mItems.clear();
+	}
+
+	void Batcher::BuildCommands()
+	{
+		mInstances.clear();
+		mCommands.clear();
+		mGroups.clear();
+
+		// Order by vertex array state first, then by range so equal ranges end up contiguous
+		auto key = [](const BatchGeometry& g) { return std::make_tuple(g.Vao, g.Primitive, g.Indexed, g.First, g.Count, g.BaseVertex); };
+
+		mOrder.resize(mItems.size());
+		std::iota(mOrder.begin(), mOrder.end(), 0);
+		std::sort(mOrder.begin(), mOrder.end(), [&](const int& a, const int& b)
+		{
+			return key(mItems[a].Geometry) < key(mItems[b].Geometry);
+		});
+
+		const BatchGeometry* prev = nullptr;
+		for (const int& idx : mOrder)
+		{
+			const BatchGeometry& g = mItems[idx].Geometry;
+
+			// New draw call when vertex array state changes
+			bool newGroup = !prev || prev->Vao != g.Vao || prev->Primitive != g.Primitive || prev->Indexed != g.Indexed;
+			if (newGroup) mGroups.push_back({ g.Vao, g.Primitive, g.Indexed, (int)mCommands.size(), 0 });
+
+			// New command when the range changes, otherwise one more instance
+			bool sameRange = !newGroup && prev->First == g.First && prev->Count == g.Count && prev->BaseVertex == g.BaseVertex;
+			if (sameRange)
+			{
+				mCommands.back().InstanceCount++;
+			}
+			else
+			{
+				GLuint baseInstance = mInstances.size();
+				if (g.Indexed) mCommands.push_back({ g.Count, 1, g.First, g.BaseVertex, baseInstance });
+				else mCommands.push_back({ g.Count, 1, g.First, (GLint)baseInstance, 0 });
+				mGroups.back().NumCommands++;
+			}
+
+			mInstances.push_back(mItems[idx].Data);
+			prev = &g;
+		}
+	}
+} // namespace X3
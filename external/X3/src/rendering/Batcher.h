@@ -0,0 +1,98 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// GL
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// X3
+#include <StreamBuffer.h>
+
+namespace X3
+{
+	// Per-instance data read by batched shaders (std430, see shaders/ubo/instances.glsl)
+	struct InstanceData
+	{
+		glm::mat4 Model;
+		glm::vec4 Color;
+		glm::vec4 Params; // x: shininess or point radius
+	};
+
+	// Range of a vertex array drawn by a batchable object
+	struct BatchGeometry
+	{
+		GLuint Vao = 0;
+		GLenum Primitive = GL_TRIANGLES;
+		bool Indexed = false;
+		GLuint First = 0; // first index or first vertex
+		GLuint Count = 0;
+		GLint BaseVertex = 0;
+	};
+
+	// Indirect command, layout of DrawElementsIndirectCommand. Array draws
+	// use the first four fields as DrawArraysIndirectCommand with the same stride.
+	struct DrawCommand
+	{
+		GLuint Count;
+		GLuint InstanceCount;
+		GLuint First;
+		GLint BaseVertex; // base instance for array draws
+		GLuint BaseInstance;
+	};
+
+	// Collects objects of one shader and draws them with multi-draw-indirect:
+	// equal geometry ranges become one instanced command and ranges sharing a
+	// vertex array become one draw call. Shaders index the instance buffer with
+	// gl_BaseInstance + gl_InstanceID.
+	class Batcher
+	{
+	public:
+
+		// Constructor
+		Batcher();
+
+		// Common methods
+		void Add(const BatchGeometry& geometry, const InstanceData& data);
+		void Render();
+
+		// Get/Set
+		bool Empty() { return mItems.empty(); }
+		int NumDrawCalls() { return mNumDrawCalls; }
+		int NumInstances() { return mInstances.size(); }
+
+	private:
+
+		struct Item
+		{
+			BatchGeometry Geometry;
+			InstanceData Data;
+		};
+
+		// Commands sharing vertex array and primitive
+		struct Group
+		{
+			GLuint Vao;
+			GLenum Primitive;
+			bool Indexed;
+			int FirstCommand;
+			int NumCommands;
+		};
+
+		// Frame data, reused between frames
+		std::vector<Item> mItems;
+		std::vector<int> mOrder;
+		std::vector<InstanceData> mInstances;
+		std::vector<DrawCommand> mCommands;
+		std::vector<Group> mGroups;
+		int mNumDrawCalls = 0;
+
+		// Render data, streamed every frame
+		StreamBuffer mSsboInstances;
+		StreamBuffer mIndirect;
+
+		// Helpers
+		void BuildCommands();
+	};
+} // namespace X3
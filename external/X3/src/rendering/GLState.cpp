@@ -0,0 +1,123 @@
+// X3
+#include <Parameters.h>
+#include <GLState.h>
+
+namespace X3
+{
+	GLState& GLState::Inst()
+	{
+		static GLState state;
+		return state;
+	}
+
+	GLState::GLState()
+	{
+		Invalidate();
+	}
+
+	void GLState::UseProgram(const GLuint& id)
+	{
+		if (!Changed(GLCall::Program, mProgram == id)) return;
+
+		glUseProgram(id);
+		mProgram = id;
+	}
+
+	void GLState::BindVertexArray(const GLuint& id)
+	{
+		if (!Changed(GLCall::Vao, mVao == id)) return;
+
+		glBindVertexArray(id);
+		mVao = id;
+	}
+
+	void GLState::ActiveTexture(const GLenum& unit)
+	{
+		// Unit switches are part of texture binding, not counted apart
+		if (mTracking && mActiveUnit == unit) return;
+
+		glActiveTexture(unit);
+		mActiveUnit = unit;
+	}
+
+	void GLState::BindTexture(const GLenum& target, const GLuint& id)
+	{
+		// Unknown active unit, nothing to compare against
+		int i = mActiveUnit - GL_TEXTURE0;
+		if (mActiveUnit == UNKNOWN || i < 0 || i >= NUM_UNITS)
+		{
+			Count(GLCall::Texture, true);
+			glBindTexture(target, id);
+			return;
+		}
+
+		if (!Changed(GLCall::Texture, mTargets[i] == target && mTextures[i] == id)) return;
+
+		glBindTexture(target, id);
+		mTargets[i] = target;
+		mTextures[i] = id;
+	}
+
+	void GLState::BindTexture(const GLenum& unit, const GLenum& target, const GLuint& id)
+	{
+		// Skips the unit switch as well when the texture is already there
+		int i = unit - GL_TEXTURE0;
+		if (mTracking && i >= 0 && i < NUM_UNITS && mTargets[i] == target && mTextures[i] == id)
+		{
+			Count(GLCall::Texture, false);
+			return;
+		}
+
+		ActiveTexture(unit);
+		BindTexture(target, id);
+	}
+
+	void GLState::Count(const GLCall& call, const bool& issued)
+	{
+		if (issued) mIssued[(int)call]++;
+		else mSkipped[(int)call]++;
+	}
+
+	void GLState::Invalidate()
+	{
+		mProgram = UNKNOWN;
+		mVao = UNKNOWN;
+		mActiveUnit = UNKNOWN;
+		mTargets.fill(UNKNOWN);
+		mTextures.fill(UNKNOWN);
+	}
+
+	void GLState::OnDeleteVertexArray(const GLuint& id)
+	{
+		if (mVao == id) mVao = 0;
+	}
+
+	void GLState::OnDeleteTexture(const GLuint& id)
+	{
+		// Unbound from every unit, whatever the target
+		for (int i = 0; i < NUM_UNITS; i++)
+		{
+			if (mTextures[i] == id) mTextures[i] = 0;
+		}
+	}
+
+	void GLState::NewFrame()
+	{
+		mLastIssued = mIssued;
+		mLastSkipped = mSkipped;
+		mIssued.fill(0);
+		mSkipped.fill(0);
+		mFrame++;
+
+		// Other libraries (ui, interop) may have touched the state between frames
+		mTracking = Parameters::Inst().RenderSettings.StateTracking;
+		Invalidate();
+	}
+
+	bool GLState::Changed(const GLCall& call, const bool& equal)
+	{
+		bool issue = !mTracking || !equal;
+		Count(call, issue);
+		return issue;
+	}
+} // namespace X3
@@ -0,0 +1,78 @@
+#pragma once
+
+// STL
+#include <cstdint>
+#include <array>
+
+// GL
+#include <glad/glad.h>
+
+namespace X3
+{
+	// Tracked kinds of state changes
+	enum class GLCall { Program, Vao, Texture, Uniform, Count };
+
+	// Singleton shadow of the bound GL state. Binds go through it so redundant
+	// changes are skipped, and issued/skipped calls are counted per frame.
+	class GLState
+	{
+	public:
+
+		// Gets the one and only instance of the state tracker
+		static GLState& Inst();
+
+		// Binds
+		void UseProgram(const GLuint& id);
+		void BindVertexArray(const GLuint& id);
+		void ActiveTexture(const GLenum& unit);
+		void BindTexture(const GLenum& target, const GLuint& id); // on the active unit
+		void BindTexture(const GLenum& unit, const GLenum& target, const GLuint& id);
+
+		// Counts a call filtered elsewhere (e.g. uniform values)
+		void Count(const GLCall& call, const bool& issued);
+
+		// Forgets cached bindings, needed after GL calls that bypass the tracker
+		void Invalidate();
+
+		// Deleted objects are unbound by GL, their names are often handed out again right away
+		void OnDeleteVertexArray(const GLuint& id);
+		void OnDeleteTexture(const GLuint& id);
+
+		// Keeps last frame counters and resets the current ones
+		void NewFrame();
+
+		// Get/Set
+		bool Tracking() { return mTracking; }
+		int Issued(const GLCall& call) { return mLastIssued[(int)call]; }
+		int Skipped(const GLCall& call) { return mLastSkipped[(int)call]; }
+		uint64_t Frame() { return mFrame; } // advanced by NewFrame
+
+	private:
+
+		static constexpr int NUM_UNITS = 32;
+		static constexpr int NUM_CALLS = (int)GLCall::Count;
+		static constexpr GLuint UNKNOWN = ~0u;
+
+		// Cached bindings
+		GLuint mProgram = UNKNOWN;
+		GLuint mVao = UNKNOWN;
+		GLenum mActiveUnit = UNKNOWN;
+		std::array<GLenum, NUM_UNITS> mTargets;
+		std::array<GLuint, NUM_UNITS> mTextures;
+		bool mTracking = true;
+		uint64_t mFrame = 0;
+
+		// Counters (current and last frame)
+		std::array<int, NUM_CALLS> mIssued{};
+		std::array<int, NUM_CALLS> mSkipped{};
+		std::array<int, NUM_CALLS> mLastIssued{};
+		std::array<int, NUM_CALLS> mLastSkipped{};
+
+		// Helpers
+		GLState(); // Private constructor to make class singleton
+		GLState(const GLState&) = delete; // No copy constructor allowed
+		void operator=(const GLState&) = delete; // No copy assignment allowed
+
+		bool Changed(const GLCall& call, const bool& equal);
+	};
+} // namespace X3
@@ -1,22 +1,23 @@
+// STL
+#include <algorithm>
+#include <cstring>
+
+// X3
 #include <RendererFwd.h>
+#include <Profiler.h>
+#include <GLState.h>
 
 namespace X3
 {
-	RendererFwd::RendererFwd()
+	RendererFwd::RendererFwd() : mUbos(GL_UNIFORM_BUFFER)
 	{
-		// Setup ubo's
-		mUboCamera.BindBufferBase(0);
-		mUboLightPoint.BindBufferBase(1);
-		mUboLightDirec.BindBufferBase(2);
-		mUboLightSpot.BindBufferBase(3);
-		mUboRendering.BindBufferBase(5);
-		
 		// Setup sky
 		mRenderSky = false;
 	}
 
 	void RendererFwd::Render(std::shared_ptr<Scene> scene, std::shared_ptr<Camera> camera)
 	{
+		ProfileZone zone("RendererFwd::Render", true);
 
 		// Managers
 		Parameters& params = Parameters::Inst();
@@ -28,6 +29,12 @@ namespace X3
 		// Update shared data
 		UpdateUbos(camera, scene->Lights());
 
+		// Hands objects inside the camera frustum to their materials
+		{
+			ProfileZone cullZone("RendererFwd::CullScene");
+			CullScene(scene, camera);
+		}
+
 		// Forward rendering
 		glViewport(0, 0, params.RenderSettings.WindowDim.x, params.RenderSettings.WindowDim.y);
 		glClearColor(params.RenderSettings.BGColor.x, params.RenderSettings.BGColor.y, params.RenderSettings.BGColor.z, 1.0f);
@@ -38,9 +45,13 @@ namespace X3
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		for (auto& shader : fwdShaders)
 		{
+			ProfileZone shaderZone(shader.first, true);
 			shader.second->Render();
 		}
 
+		// Objects leave their vertex arrays bound, releases the last one
+		GLState::Inst().BindVertexArray(0);
+
 	}
 
 	UboLight RendererFwd::LightData(std::shared_ptr<Light> l)
@@ -56,48 +67,77 @@ namespace X3
 	{
 
 	}
+	void RendererFwd::CullScene(std::shared_ptr<Scene>& scene, std::shared_ptr<Camera>& camera)
+	{
+		Parameters& params = Parameters::Inst();
+
+		// Shaders clear their visible materials after rendering, only the query result is reset
+		mVisible.clear();
+
+		if (params.RenderSettings.FrustumCulling)
+		{
+			scene->Cull(Frustum(camera->MatP(params.WindowRatio()) * camera->MatV()), mVisible);
+		}
+		else
+		{
+			for (auto& r : scene->Renderables()) mVisible.push_back(r.get());
+		}
+
+		for (auto r : mVisible)
+		{
+			if (!r->Visible()) continue;
+
+			// Cost follows the visible set, materials are handed to their shader on first user
+			std::shared_ptr<Material> material = r->FwdMaterial();
+			if (!material || !material->Owner()) continue;
+			if (material->NumVisibleUsers() == 0) material->Owner()->VisibleMaterial(material);
+			material->VisibleUser(r);
+		}
+	}
+
 	void RendererFwd::UpdateUbos(std::shared_ptr<Camera> camera, std::vector<std::shared_ptr<Light>>& lights)
 	{
 		Parameters& params = Parameters::Inst();
 
 		// Viewport camera
 		UboCamera uboCamera = camera->UboParams(params.WindowRatio());
-		mUboCamera.AddData(&uboCamera);
+		StreamUbo(0, &uboCamera, 1);
 
-		// Scene lights
-		int numDirec = 0, numSpot = 0, numPoint = 0;
-		std::vector<UboLight> uboPoint, uboDirec, uboSpot;
-		UboRendering uboRender;
+		// Scene lights, containers reused between frames
+		mLightsPoint.clear();
+		mLightsDirec.clear();
+		mLightsSpot.clear();
 
 		for (int i = 0; i < lights.size(); i++)
 		{
 			std::shared_ptr<Light> light = lights[i];
 
-			if (light->Type() == Point)
-			{
-				numPoint++;
-				uboPoint.push_back(light->UboParams());
-			}
-			else if (light->Type() == Directional)
-			{
-				numDirec++;
-				uboDirec.push_back(light->UboParams());
-			}
-			else
-			{
-				numSpot++;
-				uboSpot.push_back(light->UboParams());
-			}
+			if (light->Type() == Point) mLightsPoint.push_back(light->UboParams());
+			else if (light->Type() == Directional) mLightsDirec.push_back(light->UboParams());
+			else mLightsSpot.push_back(light->UboParams());
 		}
 
-		uboRender.NumLightDirec = numDirec;
-		uboRender.NumLightPoint = numPoint;
-		uboRender.NumLightSpot = numSpot;
+		UboRendering uboRender;
+		uboRender.NumLightDirec = mLightsDirec.size();
+		uboRender.NumLightPoint = mLightsPoint.size();
+		uboRender.NumLightSpot = mLightsSpot.size();
 		uboRender.Time = 0.f;
 
-		mUboRendering.AddData(&uboRender);
-		mUboLightDirec.AddData(uboDirec);
-		mUboLightPoint.AddData(uboPoint);
-		mUboLightSpot.AddData(uboSpot);
+		StreamUbo(1, mLightsPoint.data(), mLightsPoint.size());
+		StreamUbo(2, mLightsDirec.data(), mLightsDirec.size());
+		StreamUbo(3, mLightsSpot.data(), mLightsSpot.size());
+		StreamUbo(5, &uboRender, 1);
+	}
+
+	template <class T> void RendererFwd::StreamUbo(const GLuint& binding, const T* data, const size_t& numElements)
+	{
+		// Empty ranges can not be bound, a zeroed element stands in and the light counts skip it
+		size_t size = std::max<size_t>(numElements, 1) * sizeof(T);
+		GLintptr offset = mUbos.Allocate(size);
+
+		if (numElements > 0) std::memcpy(mUbos.Ptr(offset), data, size);
+		else std::memset(mUbos.Ptr(offset), 0, size);
+
+		mUbos.BindBufferRange(binding, offset, size);
 	}
 } // namespace X3
\ No newline at end of file
@@ -7,8 +7,8 @@
 #include <Parameters.h>
 #include <Renderer.h>
 #include <Camera.h>
+#include <StreamBuffer.h>
 #include <Scene.h>
-#include <Ubo.h>
 
 namespace X3
 {
@@ -23,17 +23,19 @@ namespace X3
 		void Resize(const glm::ivec2& d) override;
 		void Update() override;
 	private:
-		// Shared data
-		Ubo<UboRendering> mUboRendering;
-		Ubo<UboLight> mUboLightPoint;
-		Ubo<UboLight> mUboLightDirec;
-		Ubo<UboLight> mUboLightSpot;
-		Ubo<UboCamera> mUboCamera;
+		// Shared data, sub-allocated per viewport and frame
+		StreamBuffer mUbos;
+		std::vector<UboLight> mLightsPoint, mLightsDirec, mLightsSpot;
+
+		// Culling output, reused between frames
+		std::vector<Renderable*> mVisible;
 
 		// Misc
 		bool mRenderSky;
 
 		// Helpers
+		void CullScene(std::shared_ptr<Scene>& scene, std::shared_ptr<Camera>& camera);
 		void UpdateUbos(std::shared_ptr<Camera> camera, std::vector<std::shared_ptr<Light>>& lights);
+		template <class T> void StreamUbo(const GLuint& binding, const T* data, const size_t& numElements);
 	};
 } // namespace X3
\ No newline at end of file
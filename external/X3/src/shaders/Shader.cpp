@@ -1,8 +1,13 @@
 // STL
 #include <iostream>
+#include <cstdio>
 
 // XE
+#include <Parameters.h>
 #include <STLUtils.h>
+#include <Profiler.h>
+#include <Shaders.h>
+#include <GLState.h>
 #include <Material.h>
 #include <Camera.h>
 #include <Shader.h>
@@ -10,6 +15,16 @@
 
 namespace X3
 {
+    // Uniform names hashed at compile time
+    static constexpr UniformId UNIF_INSTANCED("Instanced");
+
+    // FNV-1a, continued over several strings
+    static uint64_t HashText(const std::string& text, uint64_t hash = 14695981039346656037ull)
+    {
+        for (const char& c : text) hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        return hash;
+    }
+
     Shader::~Shader()
     {
         Delete();
@@ -25,12 +40,34 @@ namespace X3
 
     bool Shader::Link()
     {
-        if (mLinked) {
-            return true;
+        Finish();
+        return mLinked;
+    }
+
+    bool Shader::Compiling() const
+    {
+        // Without the extension the status query would block, the program is reported as done
+#ifdef GL_KHR_parallel_shader_compile
+        if (mPending && Shaders::Inst().ParallelCompile())
+        {
+            GLint done = GL_FALSE;
+            glGetProgramiv(mProgramID, GL_COMPLETION_STATUS_KHR, &done);
+            return done == GL_FALSE;
         }
+#endif
+        return false;
+    }
+
+    void Shader::Finish()
+    {
+        if (!mPending) return;
+        mPending = false;
+
+        ProfileZone zone("Shader::Finish");
+
+        // Compile errors are only reported now, the link was issued without waiting
+        bool compiled = CheckShaders();
 
-        // Try to link program and get the link status
-        glLinkProgram(mProgramID);
         GLint linkStatus;
         glGetProgramiv(mProgramID, GL_LINK_STATUS, &linkStatus);
         mLinked = linkStatus == GL_TRUE;
@@ -53,21 +90,57 @@ namespace X3
             }
 
             std::cerr << std::endl;
-            return false;
         }
 
-        return mLinked;
+        // After linking, shaders can be detached and erased
+        DetachShaders();
+        DeleteShaders();
+        if (!mLinked) return;
+
+        // Fill vertex attributes and uniforms
+        FindActiveAttribs();
+        FindActiveUniforms();
+
+        if (compiled) Shaders::Inst().SaveBinary(mBinaryName, mHash, mProgramID);
+    }
+
+    void Shader::Rebuild()
+    {
+        Finish();
+
+        // Builds aside, a broken edit keeps the previous program running
+        GLuint oldID = mProgramID;
+        bool oldLinked = mLinked;
+        mProgramID = glCreateProgram();
+        mLinked = false;
+
+        BuildShader();
+        Finish();
+
+        if (!mLinked)
+        {
+            glDeleteProgram(mProgramID);
+            mProgramID = oldID;
+            mLinked = oldLinked;
+            return;
+        }
+
+        glDeleteProgram(oldID);
+        GLState::Inst().Invalidate();
     }
 
-    void Shader::Use() const
+    void Shader::Use()
     {
-        if (mLinked) glUseProgram(mProgramID);
+        Finish();
+        if (mLinked) GLState::Inst().UseProgram(mProgramID);
         else printf("Trying to use a shader that is not linked!\n");
     }
 
-    void Shader::Unuse() const
+    void Shader::Unuse()
     {
-        if (mLinked) glUseProgram(0);
+        Finish();
+
+        if (mLinked) GLState::Inst().UseProgram(0);
         else printf("Trying to unuse a shader that is not linked!\n");
     }
 
@@ -75,25 +148,54 @@ namespace X3
     {
         if (mProgramID == 0) return;
 
+        // Shaders of a build that was never finished
+        DetachShaders();
+        DeleteShaders();
+        mPending = false;
+
         glDeleteProgram(mProgramID);
+        GLState::Inst().Invalidate();
         mUniforms.clear();
         mAttribs.clear();
         mLinked = false;
     }
 
+    void Shader::AddMaterial(const std::shared_ptr<Material>& material)
+    {
+        mMaterials.push_back(material);
+        material->Owner(this);
+    }
+
     void Shader::Render()
     {
+        // Only materials with visible users, preloaded programs nobody uses are not finished
+        if (mVisibleMaterials.empty()) return;
+
         // Activate shader
         this->Use();
 
-        // Render all materials using this shader
-        for (int i = 0; i < mMaterials.size(); i++)
+        // Render the visible materials using this shader
+        bool batching = Parameters::Inst().RenderSettings.Batching;
+        for (auto& material : mVisibleMaterials)
+        {
+            // Batched users are drawn below, skips materials with nothing left
+            if (batching) material->Batch(mBatcher);
+            if (material->NumVisibleUsers() > 0) material->Render(shared_from_this());
+        }
+
+        // Batched users of all materials in a few indirect draws
+        if (!mBatcher.Empty())
         {
-            mMaterials[i].lock()->Render(shared_from_this());
+            Unif(UNIF_INSTANCED) = true;
+            mBatcher.Render();
+            Unif(UNIF_INSTANCED) = false;
         }
 
-        // Desactivate shader
-        this->Unuse();
+        // Visible sets are per viewport
+        for (auto& material : mVisibleMaterials) material->ClearVisibleUsers();
+        mVisibleMaterials.clear();
+
+        // Program stays bound, the state tracker skips it if the next shader is the same
     }
 
     void Shader::Update()
@@ -101,39 +203,46 @@ namespace X3
         utils::EraseExpiredPointers(mMaterials);
     }
 
-    int Shader::GetAttribLocation(std::string name) const
+    int Shader::GetAttribLocation(std::string name)
     {
+        Finish();
         return mAttribs.at(name);
     }
 
-    bool Shader::HasAttrib(const std::string name) const
+    bool Shader::HasAttrib(const std::string name)
     {
+        Finish();
         return mAttribs.find(name) != mAttribs.end();
     }
 
-    GLuint Shader::GetID() const
+    GLuint Shader::GetID()
     {
+        Finish();
         return mProgramID;
     }
 
-    Uniform& Shader::operator[](const std::string& varName)
+    Uniform& Shader::operator[](const UniformId& varName)
     {
-        if (mUniforms.count(varName) == 0)
-        {
-            mUniforms[varName] = Uniform(varName, this);
-        }
-
-        return mUniforms[varName];
+        return Unif(varName);
     }
 
-    Uniform& Shader::Unif(const std::string& varName)
+    Uniform& Shader::Unif(const UniformId& varName)
     {
-        if (mUniforms.count(varName) == 0)
+        Finish();
+        auto it = mUniforms.find(varName.Hash);
+        if (it == mUniforms.end())
+        {
+            it = mUniforms.emplace(varName.Hash, Uniform(varName.Name, this)).first;
+        }
+#ifndef NDEBUG
+        // Keyed by hash only, a collision would silently write another uniform
+        else if (it->second.Name() != varName.Name)
         {
-            mUniforms[varName] = Uniform(varName, this);
+            printf("Uniform hash collision between %s and %s!\n", it->second.Name().c_str(), varName.Name);
         }
+#endif
 
-        return mUniforms[varName];
+        return it->second;
     }
 
     // Model and normal matrix setting is pretty common, that's why this convenience function
@@ -144,8 +253,9 @@ namespace X3
         //(*this)[ShaderConstants::normalMatrix()] = glm::transpose(glm::inverse(glm::mat3(modelMatrix)));
     }
 
-    GLuint Shader::GetUniformBlockIndex(const std::string& uniformBlockName) const
+    GLuint Shader::GetUniformBlockIndex(const std::string& uniformBlockName)
     {
+        Finish();
         if (!mLinked)
         {
             std::cerr << "Cannot get index of uniform block " << uniformBlockName << " when program has not been linked!" << std::endl;
@@ -160,7 +270,7 @@ namespace X3
         return result;
     }
 
-    void Shader::BindUniformBlockToBindingPoint(const std::string& uniformBlockName, const GLuint bindingPoint) const
+    void Shader::BindUniformBlockToBindingPoint(const std::string& uniformBlockName, const GLuint bindingPoint)
     {
         const auto blockIndex = GetUniformBlockIndex(uniformBlockName);
         if (blockIndex != GL_INVALID_INDEX) {
@@ -178,97 +288,45 @@ namespace X3
         glTransformFeedbackVaryings(mProgramID, static_cast<GLsizei>(recordedVariablesNamesPtrs.size()), recordedVariablesNamesPtrs.data(), bufferMode);
     }
 
-    bool Shader::GetLinesFromFile(const std::string& fileName, std::vector<std::string>& result, std::set<std::string>& filesIncludedAlready, bool isReadingIncludedFile) const
+    void Shader::BuildShader()
     {
-        std::ifstream file(fileName);
-        if (!file.good())
-        {
-            std::cout << "File " << fileName << " not found! (Have you set the working directory of the application to $(SolutionDir)bin/?)" << std::endl;
-            return false;
-        }
+        ProfileZone zone("Shader::BuildShader");
 
-        std::string startDirectory;
-        auto slashCharacter = '/';
-        auto normFileName = utils::normalizeSlashes(fileName, slashCharacter);
+        // Expanded sources, the binary is keyed by them and the driver
+        std::vector<std::string> sources(mShadersFn.size());
+        std::vector<bool> found(mShadersFn.size());
+        mDependencies.clear();
+        mBinaryName.clear();
+        mHash = HashText(Shaders::Inst().DriverId());
 
-        size_t slashIndex = -1;
-        for (auto i = static_cast<int>(fileName.size()) - 1; i >= 0; i--)
+        for (int i = 0; i < mShadersFn.size(); i++)
         {
-            if (fileName[i] == slashCharacter)
-            {
-                slashIndex = i;
-                slashCharacter = fileName[i];
-                break;
-            }
+            found[i] = Shaders::Inst().Source(mShadersFn[i], sources[i], mDependencies);
+            mHash = HashText(mShadersFn[i], mHash);
+            mHash = HashText(sources[i], mHash);
+            mBinaryName += mShadersFn[i];
         }
 
-        startDirectory = fileName.substr(0, slashIndex + 1);
-
-        // Get all lines from a file
-        std::string line;
-        auto isInsideIncludePart = false;
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx", (unsigned long long)HashText(mBinaryName));
+        mBinaryName = name;
 
-        while (std::getline(file, line))
+        if (Shaders::Inst().LoadBinary(mBinaryName, mHash, mProgramID))
         {
-            line += "\n"; // getline does not keep newline character
-            std::stringstream ss(line);
-            std::string firstToken;
-            ss >> firstToken;
-            if (firstToken == "#include")
-            {
-                std::string includeFileName;
-                ss >> includeFileName;
-                if (includeFileName.size() > 0 && includeFileName[0] == '\"' && includeFileName[includeFileName.size() - 1] == '\"')
-                {
-                    includeFileName = utils::normalizeSlashes(includeFileName.substr(1, includeFileName.size() - 2), slashCharacter);
-                    std::string directory = startDirectory;
-                    std::vector<std::string> subPaths = utils::split(includeFileName, slashCharacter);
-                    std::string sFinalFileName = "";
-                    for (const std::string& subPath : subPaths)
-                    {
-                        if (subPath == "..")
-                            directory = utils::upOneDirectory(directory, slashCharacter);
-                        else
-                        {
-                            if (sFinalFileName.size() > 0)
-                                sFinalFileName += slashCharacter;
-                            sFinalFileName += subPath;
-                        }
-                    }
-
-                    const auto combinedIncludeFilePath = directory + sFinalFileName;
-                    if (filesIncludedAlready.find(combinedIncludeFilePath) == filesIncludedAlready.end())
-                    {
-                        std::string headOS = "";
-                        if (CURRENT_OS == 1) headOS = "/";
-                        filesIncludedAlready.insert(combinedIncludeFilePath);
-                        GetLinesFromFile(headOS + directory + sFinalFileName, result, filesIncludedAlready, false);
-                    }
-                }
-            }
-            else if (firstToken == "#include_part")
-                isInsideIncludePart = true;
-            else if (firstToken == "#definition_part")
-                isInsideIncludePart = false;
-            else if (!isReadingIncludedFile || (isReadingIncludedFile && isInsideIncludePart))
-                result.push_back(line);
+            mLinked = true;
+            FindActiveAttribs();
+            FindActiveUniforms();
+            return;
         }
 
-        file.close();
-        return true;
-    }
-
-    void Shader::BuildShader()
-    {
         // Compile shader programs
-        for (const auto& fn : mShadersFn) CompileShaderProgram(fn);
+        for (int i = 0; i < mShadersFn.size(); i++)
+        {
+            if (found[i]) CompileShaderProgram(mShadersFn[i], sources[i]);
+        }
 
-        // Attach all programs and links shader
+        // Attach all programs and links shader, status is checked in Finish
         AttachShaders();
-
-        // Fill vertex attributes
-        FindActiveAttribs();
-
     }
 
     void Shader::FindActiveAttribs()
@@ -292,6 +350,43 @@ namespace X3
         }
     }
 
+    void Shader::FindActiveUniforms()
+    {
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(mProgramID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(mProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::vector<GLchar> name(maxLength + 1);
+        mUniforms.clear();
+
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size; // array size
+            GLenum type;
+            GLsizei length;
+            glGetActiveUniform(mProgramID, (GLuint)i, maxLength + 1, &length, &size, &type, name.data());
+
+            // Uniform block members have no location
+            std::string varName(name.data(), length);
+            GLint location = glGetUniformLocation(mProgramID, varName.c_str());
+            if (location == -1) continue;
+
+            mUniforms.emplace(UniformId(varName).Hash, Uniform(varName, this, location));
+
+            // Arrays are reported as "name[0]", registers the other elements too
+            if (size > 1 && varName.size() > 3 && varName.compare(varName.size() - 3, 3, "[0]") == 0)
+            {
+                std::string base = varName.substr(0, varName.size() - 3);
+                for (GLint j = 1; j < size; j++)
+                {
+                    std::string element = base + "[" + std::to_string(j) + "]";
+                    mUniforms.emplace(UniformId(element).Hash, Uniform(element, this, glGetUniformLocation(mProgramID, element.c_str())));
+                }
+            }
+        }
+    }
+
     void Shader::AttachShaders()
     {
         for (const auto& shaderObj : mShaderPrograms)
@@ -299,12 +394,10 @@ namespace X3
             if (shaderObj.second != 0) glAttachShader(mProgramID, shaderObj.second);
         }
 
-        // After linking, shaders can be detached and erased
-        if (Link())
-        {
-            DetachShaders();
-            DeleteShaders();
-        }
+        // Drivers may compile and link on their own threads until the status is queried
+        glProgramParameteri(mProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(mProgramID);
+        mPending = true;
     }
 
     void Shader::DetachShaders()
@@ -325,52 +418,51 @@ namespace X3
         mShaderPrograms.clear();
     }
 
-    void Shader::CompileShaderProgram(const std::string& fn)
+    void Shader::CompileShaderProgram(const std::string& fn, const std::string& source)
     {
-
-
-        // Load file
-        std::vector<std::string> fileLines;
-        std::set<std::string> filesIncludedAlready;
-
-        if (!GetLinesFromFile(fn, fileLines, filesIncludedAlready)) return;
-
-        std::vector<const char*> programSource;
-        for (const auto& line : fileLines) programSource.push_back(line.c_str());
-
         // Create and compile shader
         GLuint shaderID = 0;
         GLenum shaderType = ShaderTypeFromFn(fn);
         shaderID = glCreateShader(shaderType);
-        glShaderSource(shaderID, static_cast<GLsizei>(fileLines.size()), programSource.data(), nullptr);
+        const char* text = source.c_str();
+        glShaderSource(shaderID, 1, &text, nullptr);
         glCompileShader(shaderID);
 
-        // Get and check the compilation status
-        GLint compilationStatus;
-        glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compilationStatus);
-        if (compilationStatus == GL_FALSE)
+        mShaderPrograms.insert(std::pair<GLenum, GLuint>(shaderType, shaderID));
+        mShaderFns[shaderType] = fn;
+    }
+
+    bool Shader::CheckShaders()
+    {
+        bool compiled = true;
+        for (const auto& shaderObj : mShaderPrograms)
         {
-            std::cerr << "Error! Shader file " << fn << " wasn't compiled!";
+            // Get and check the compilation status
+            GLint compilationStatus;
+            glGetShaderiv(shaderObj.second, GL_COMPILE_STATUS, &compilationStatus);
+            if (compilationStatus == GL_TRUE) continue;
+
+            compiled = false;
+            std::cerr << "Error! Shader file " << mShaderFns[shaderObj.first] << " wasn't compiled!";
 
             // Get length of the error log first
             GLint logLength;
-            glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &logLength);
+            glGetShaderiv(shaderObj.second, GL_INFO_LOG_LENGTH, &logLength);
 
             // If there is some log, then retrieve it and output extra information
             if (logLength > 0)
             {
                 GLchar* logMessage = new GLchar[logLength];
-                glGetShaderInfoLog(shaderID, logLength, nullptr, logMessage);
+                glGetShaderInfoLog(shaderObj.second, logLength, nullptr, logMessage);
                 std::cerr << " The compiler returned: " << std::endl << std::endl << logMessage;
                 delete[] logMessage;
             }
 
             std::cerr << std::endl;
         }
-        else
-        {
-            mShaderPrograms.insert(std::pair<GLenum, GLuint>(shaderType, shaderID));
-        }
+
+        // Stages whose file is missing were never compiled
+        return compiled && mShaderPrograms.size() == mShadersFn.size();
     }
 
     GLenum Shader::ShaderTypeFromFn(const std::string& fn)
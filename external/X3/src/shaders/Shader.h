@@ -1,6 +1,7 @@
 #pragma once
 
 // STL
+#include <unordered_map>
 #include <map>
 #include <string>
 #include <fstream>
@@ -14,6 +15,7 @@
 // X3
 #include <StringUtils.h>
 #include <Uniform.h>
+#include <Batcher.h>
 
 namespace X3
 {
@@ -41,29 +43,40 @@ namespace X3
         void Update();
 
         // Common methods
-        void Unuse() const;
-        void Use() const;
+        void Unuse();
+        void Use();
         void Delete();
         bool Link();
 
+        // Asynchronous builds. Programs are finished (status checks, reflection) on first use, or
+        // earlier when the driver reports completion
+        bool Pending() const { return mPending; }
+        bool Compiling() const;
+        void Finish();
+        void Rebuild();
+
         // Get/Set
-        void AddMaterial(const std::shared_ptr<Material>& material) { mMaterials.push_back(material); }
-        int GetAttribLocation(std::string name) const;
-        bool HasAttrib(const std::string name) const;
-        GLuint GetID() const;
+        void AddMaterial(const std::shared_ptr<Material>& material);
+
+        // Materials with visible users in the viewport being rendered, cleared after rendering
+        void VisibleMaterial(const std::shared_ptr<Material>& material) { mVisibleMaterials.push_back(material); }
+        const std::vector<std::string>& Dependencies() const { return mDependencies; }
+        int GetAttribLocation(std::string name);
+        bool HasAttrib(const std::string name);
+        GLuint GetID();
 
-        // Gets uniform variable by name. If it's first time, it creates a new one, otherwise it's retrieved from cache.
-        Uniform& operator[](const std::string& varName);
-        Uniform& Unif(const std::string& varName);
+        // Gets uniform variable by name. Active uniforms are resolved at link time, others are created on first use.
+        Uniform& operator[](const UniformId& varName);
+        Uniform& Unif(const UniformId& varName);
 
         // Sets model and normal matrix
         void SetModelMat(const glm::mat4& modelMatrix);
 
         // Gets index of given uniform block in this shader program.
-        GLuint GetUniformBlockIndex(const std::string& uniformBlockName) const;
+        GLuint GetUniformBlockIndex(const std::string& uniformBlockName);
 
         // Binds uniform block of this program to a uniform binding point.
-        void BindUniformBlockToBindingPoint(const std::string& uniformBlockName, GLuint bindingPoint) const;
+        void BindUniformBlockToBindingPoint(const std::string& uniformBlockName, GLuint bindingPoint);
 
         // Tells OpenGL, which output variables should be recorded during transform feedback.
         void SetTransformFeedbackRecordedVariables(const std::vector<std::string>& recordedVariablesNames, GLenum bufferMode = GL_INTERLEAVED_ATTRIBS) const;
@@ -73,21 +86,29 @@ namespace X3
         // General info
         GLuint mProgramID{ 0 }; // OpenGL-assigned shader program ID
         bool mLinked{ false }; // Flag teling, whether shader program has been linked successfully
+        bool mPending{ false }; // Link issued, status not checked yet
+        uint64_t mHash{ 0 }; // expanded sources and driver, keys the program binary
+        std::string mBinaryName; // program binary file, from the shader file names
 
         // Shader data
-        std::map<std::string, Uniform> mUniforms; // Cache of uniform locations (reduces OpenGL calls)
+        std::unordered_map<uint64_t, Uniform> mUniforms; // Cache of uniforms by name hash (reduces OpenGL calls)
         std::map<GLenum, GLuint> mShaderPrograms; // Programs of this shader (vertex, fragment, etc.)
+        std::map<GLenum, std::string> mShaderFns; // File of each program, for compile errors
         std::map<std::string, int> mAttribs; // Cache of shader program attributes
         std::vector<std::string> mShadersFn; // Files containing shaders
+        std::vector<std::string> mDependencies; // Shader files and their includes
 
         // Associated materials
         std::vector<std::weak_ptr<Material>> mMaterials;
+        std::vector<std::shared_ptr<Material>> mVisibleMaterials;
+        Batcher mBatcher; // indirect draws of batchable material users
 
         // Helpers
-        bool GetLinesFromFile(const std::string& fileName, std::vector<std::string>& result, std::set<std::string>& filesIncludedAlready, bool isReadingIncludedFile = false) const;
-        void CompileShaderProgram(const std::string& fn);
+        void CompileShaderProgram(const std::string& fn, const std::string& source);
+        bool CheckShaders();
         GLenum ShaderTypeFromFn(const std::string& fn);
         void FindActiveAttribs();
+        void FindActiveUniforms();
         void AttachShaders();
         void DetachShaders();
         void DeleteShaders();
@@ -1,12 +1,35 @@
 // STL
 #include <iostream>
 #include <stdexcept>
+#include <fstream>
+#include <cstring>
 
 // X3
+#include <Parameters.h>
 #include <Shaders.h>
+#include <Profiler.h>
 
 namespace X3
 {
+    // Program binary file, the blob follows the header
+    struct BinaryHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t Hash; // expanded sources and driver
+        uint32_t Format;
+        uint32_t Size;
+    };
+
+    static const char BINARY_MAGIC[4] = { 'X', '3', 'S', 'B' };
+    static const uint32_t BINARY_VERSION = 1;
+
+    // Seconds between checks for modified shader files
+    static const float RELOAD_PERIOD = 0.5f;
+
+    // Programs finished per update when the driver can not tell whether they are done
+    static const int FINISH_PER_UPDATE = 2;
+
     Shaders& Shaders::Inst()
     {
         static Shaders spm;
@@ -15,11 +38,28 @@ namespace X3
 
     void Shaders::Update()
     {
+        ProfileZone zone("Shaders::Update");
+
+        // Finishes programs built in the background, unused ones included so their errors are
+        // reported and their binaries cached. Without completion queries a few may wait per update
+        bool parallel = ParallelCompile();
+        int budget = FINISH_PER_UPDATE;
+        for (auto& shader : mFwdCache)
+        {
+            if (!shader.second->Pending()) continue;
+
+            if (parallel && !shader.second->Compiling()) shader.second->Finish();
+            else if (!parallel && budget-- > 0) shader.second->Finish();
+        }
+
+        if (Parameters::Inst().Main.ShaderAutoReload) ReloadModified();
+
         for (auto& shader : mFwdCache) shader.second->Update();
     }
 
     std::shared_ptr<Shader> Shaders::Load(const std::string& key, const std::vector<std::string>& shadersFn)
     {
+        ProfileZone zone("Shaders::Load");
         if (!ContainsShaderProgram(key)) mFwdCache[key] = std::make_shared<Shader>(shadersFn);
 
         return mFwdCache.at(key);
@@ -45,10 +85,272 @@ namespace X3
     void Shaders::ClearProgramCache()
     {
         mFwdCache.clear();
+        mFiles.clear();
+    }
+
+    bool Shaders::Source(const std::string& fn, std::string& text, std::vector<std::string>& files)
+    {
+        std::set<std::string> included;
+        return Expand(fn, text, files, included);
+    }
+
+    bool Shaders::LoadBinary(const std::string& name, const uint64_t& hash, const GLuint& program)
+    {
+        if (!Parameters::Inst().Main.ShaderCache) return false;
+
+        // Drivers may not support any binary format
+        if (mNumBinaryFormats < 0) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &mNumBinaryFormats);
+        if (mNumBinaryFormats == 0) return false;
+
+        std::ifstream in(BinaryFn(name), std::ios::binary);
+        if (!in.good()) return false;
+
+        BinaryHeader header;
+        in.read((char*)&header, sizeof(header));
+        if (!in.good() || std::memcmp(header.Magic, BINARY_MAGIC, 4) != 0 || header.Version != BINARY_VERSION || header.Hash != hash) return false;
+
+        std::vector<char> blob(header.Size);
+        in.read(blob.data(), blob.size());
+        if (!in.good()) return false;
+
+        // Rejected binaries (driver updates) fall back to a regular build
+        glProgramBinary(program, header.Format, blob.data(), blob.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE) return false;
+
+        mBinaryHits++;
+        return true;
+    }
+
+    void Shaders::SaveBinary(const std::string& name, const uint64_t& hash, const GLuint& program)
+    {
+        if (!Parameters::Inst().Main.ShaderCache || mNumBinaryFormats == 0) return;
+
+        GLint size = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+        if (size <= 0) return;
+
+        BinaryHeader header;
+        std::memcpy(header.Magic, BINARY_MAGIC, 4);
+        header.Version = BINARY_VERSION;
+        header.Hash = hash;
+
+        std::vector<char> blob(size);
+        GLenum format = 0;
+        glGetProgramBinary(program, size, nullptr, &format, blob.data());
+        header.Format = format;
+        header.Size = size;
+
+        // Written aside and renamed, so readers never see a partial file
+        std::error_code ec;
+        std::string fn = BinaryFn(name);
+        std::string tmpFn = fn + ".tmp";
+        std::filesystem::create_directories(std::filesystem::path(fn).parent_path(), ec);
+
+        std::ofstream out(tmpFn, std::ios::binary | std::ios::trunc);
+        if (!out.good())
+        {
+            printf("Shader cache: can not write %s\n", tmpFn.c_str());
+            return;
+        }
+
+        out.write((const char*)&header, sizeof(header));
+        out.write(blob.data(), blob.size());
+        out.close();
+
+        if (out.good()) std::filesystem::rename(tmpFn, fn, ec);
+        if (!out.good() || ec) std::filesystem::remove(tmpFn, ec);
+    }
+
+    bool Shaders::ParallelCompile()
+    {
+        if (mParallelCompile < 0)
+        {
+            mParallelCompile = 0;
+#ifdef GL_KHR_parallel_shader_compile
+            if (GLAD_GL_KHR_parallel_shader_compile)
+            {
+                // Lets the driver choose the number of compiler threads
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+                mParallelCompile = 1;
+            }
+#endif
+        }
+
+        return mParallelCompile == 1;
+    }
+
+    const std::string& Shaders::DriverId()
+    {
+        if (mDriverId.empty())
+        {
+            for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION })
+            {
+                const GLubyte* str = glGetString(name);
+                if (str) mDriverId += (const char*)str;
+                mDriverId += "\n";
+            }
+        }
+
+        return mDriverId;
     }
 
     bool Shaders::ContainsShaderProgram(const std::string& key) const
     {
         return mFwdCache.count(key) > 0;
     }
+
+    const Shaders::SourceFile& Shaders::File(const std::string& fn)
+    {
+        auto it = mFiles.find(fn);
+        if (it != mFiles.end()) return it->second;
+
+        SourceFile& file = mFiles[fn];
+
+        // Missing files are kept too, so creating them triggers a reload
+        std::error_code ec;
+        file.Time = std::filesystem::last_write_time(fn, ec);
+        std::ifstream in(fn);
+        if (ec || !in.good())
+        {
+            std::cout << "File " << fn << " not found! (Have you set the working directory of the application to $(SolutionDir)bin/?)" << std::endl;
+            return file;
+        }
+
+        file.Exists = true;
+
+        // Include paths are resolved relative to the including file
+        std::string startDirectory;
+        auto slashCharacter = '/';
+
+        size_t slashIndex = -1;
+        for (auto i = static_cast<int>(fn.size()) - 1; i >= 0; i--)
+        {
+            if (fn[i] == slashCharacter)
+            {
+                slashIndex = i;
+                slashCharacter = fn[i];
+                break;
+            }
+        }
+
+        startDirectory = fn.substr(0, slashIndex + 1);
+
+        // Splits the file into text runs and includes
+        std::string line;
+        std::string text;
+
+        while (std::getline(in, line))
+        {
+            // First token, without stringstreams
+            size_t begin = line.find_first_not_of(" \t\r");
+            size_t end = begin == std::string::npos ? begin : line.find_first_of(" \t\r", begin);
+            std::string firstToken = begin == std::string::npos ? "" : line.substr(begin, end - begin);
+
+            if (firstToken == "#include")
+            {
+                size_t nameBegin = end == std::string::npos ? end : line.find_first_not_of(" \t\r", end);
+                size_t nameEnd = nameBegin == std::string::npos ? nameBegin : line.find_first_of(" \t\r", nameBegin);
+                std::string includeFileName = nameBegin == std::string::npos ? "" : line.substr(nameBegin, nameEnd - nameBegin);
+
+                if (includeFileName.size() > 0 && includeFileName[0] == '\"' && includeFileName[includeFileName.size() - 1] == '\"')
+                {
+                    includeFileName = utils::normalizeSlashes(includeFileName.substr(1, includeFileName.size() - 2), slashCharacter);
+                    std::string directory = startDirectory;
+                    std::vector<std::string> subPaths = utils::split(includeFileName, slashCharacter);
+                    std::string sFinalFileName = "";
+                    for (const std::string& subPath : subPaths)
+                    {
+                        if (subPath == "..")
+                            directory = utils::upOneDirectory(directory, slashCharacter);
+                        else
+                        {
+                            if (sFinalFileName.size() > 0)
+                                sFinalFileName += slashCharacter;
+                            sFinalFileName += subPath;
+                        }
+                    }
+
+                    // Splitting drops the leading slash of absolute paths
+                    std::string headOS = "";
+                    if (CURRENT_OS == 1 && (directory.empty() || directory[0] != '/')) headOS = "/";
+
+                    file.Text.push_back(std::move(text));
+                    file.Includes.push_back(headOS + directory + sFinalFileName);
+                    text.clear();
+                }
+            }
+            else if (firstToken != "#include_part" && firstToken != "#definition_part")
+            {
+                text += line;
+                text += "\n"; // getline does not keep newline character
+            }
+        }
+
+        file.Text.push_back(std::move(text));
+        file.Includes.push_back("");
+
+        return file;
+    }
+
+    bool Shaders::Expand(const std::string& fn, std::string& text, std::vector<std::string>& files, std::set<std::string>& included)
+    {
+        files.push_back(fn);
+        const SourceFile& file = File(fn);
+        if (!file.Exists) return false;
+
+        // Each file is included once per stage
+        for (int i = 0; i < file.Text.size(); i++)
+        {
+            text += file.Text[i];
+            const std::string& include = file.Includes[i];
+            if (!include.empty() && included.insert(include).second) Expand(include, text, files, included);
+        }
+
+        return true;
+    }
+
+    void Shaders::ReloadModified()
+    {
+        // Throttled, each file is checked once whatever the number of programs including it
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - mLastCheck).count() < RELOAD_PERIOD) return;
+        mLastCheck = now;
+
+        std::set<std::string> modified;
+        for (auto it = mFiles.begin(); it != mFiles.end(); )
+        {
+            std::error_code ec;
+            std::filesystem::file_time_type time = std::filesystem::last_write_time(it->first, ec);
+            bool exists = !ec;
+
+            if (exists != it->second.Exists || (exists && time != it->second.Time))
+            {
+                modified.insert(it->first);
+                it = mFiles.erase(it);
+            }
+            else ++it;
+        }
+
+        if (modified.empty()) return;
+
+        // Only programs whose include graph contains a modified file are rebuilt
+        for (auto& shader : mFwdCache)
+        {
+            for (const std::string& fn : shader.second->Dependencies())
+            {
+                if (modified.count(fn) == 0) continue;
+
+                std::cout << "Reloading shader " << shader.first << " (" << fn << " changed)" << std::endl;
+                shader.second->Rebuild();
+                break;
+            }
+        }
+    }
+
+    std::string Shaders::BinaryFn(const std::string& name) const
+    {
+        return Parameters::Inst().Main.CacheDir + "/shaders/" + name + ".bin";
+    }
 }
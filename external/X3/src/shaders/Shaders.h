@@ -1,8 +1,13 @@
 #pragma once
 
 // STL
+#include <unordered_map>
+#include <filesystem>
+#include <chrono>
 #include <string>
+#include <vector>
 #include <map>
+#include <set>
 #include <memory>
 
 // GL
@@ -23,7 +28,8 @@ namespace X3
 		// Main-loop methods
 		void Update();
 
-		// Creates new shader program and stores it with specified key.
+		// Creates new shader program and stores it with specified key. The driver builds it in the
+		// background, it is finished on first use.
 		std::shared_ptr<Shader> Load(const std::string& key, const std::vector<std::string>& shadersFn);
 
 		// Creates new shader program and stores it with specified key (just using vertex and fragment).
@@ -38,17 +44,51 @@ namespace X3
 		// Deletes all the shader programs loaded and clears the shader program cache.
 		void ClearProgramCache();
 
+		// Expands includes of a shader file. Files are parsed once and kept until they change on disk,
+		// files lists the main file and every include, missing ones too.
+		bool Source(const std::string& fn, std::string& text, std::vector<std::string>& files);
+
+		// Program binaries in Main.CacheDir, keyed by the expanded sources and the driver
+		bool LoadBinary(const std::string& name, const uint64_t& hash, const GLuint& program);
+		void SaveBinary(const std::string& name, const uint64_t& hash, const GLuint& program);
+
 		// Get/Set
 		int CacheSize() { return mFwdCache.size(); }
+		int NumBinaryHits() { return mBinaryHits; }
+		bool ParallelCompile();
+		const std::string& DriverId();
 
 	private:
 		Shaders() {} // Private constructor to make class singleton
 		Shaders(const Shaders&) = delete; // No copy constructor allowed
 		void operator=(const Shaders&) = delete; // No copy assignment allowed
 
+		// Parsed shader file, text runs separated by resolved includes
+		struct SourceFile
+		{
+			std::vector<std::string> Text;
+			std::vector<std::string> Includes; // empty between consecutive text runs
+			std::filesystem::file_time_type Time;
+			bool Exists = false;
+		};
+
 		std::map<std::string, std::shared_ptr<Shader>> mFwdCache; // Fwd shader program
-		
+		std::unordered_map<std::string, SourceFile> mFiles; // include cache
+
+		// Driver info
+		std::string mDriverId;
+		int mNumBinaryFormats = -1;
+		int mParallelCompile = -1;
+		int mBinaryHits = 0;
+
+		// Hot reload
+		std::chrono::steady_clock::time_point mLastCheck;
+
 		// Helpers
 		bool ContainsShaderProgram(const std::string& key) const;
+		const SourceFile& File(const std::string& fn);
+		bool Expand(const std::string& fn, std::string& text, std::vector<std::string>& files, std::set<std::string>& included);
+		void ReloadModified();
+		std::string BinaryFn(const std::string& name) const;
 	};
-} // namespace X3
\ No newline at end of file
+} // namespace X3
@@ -1,6 +1,8 @@
 #include <iostream>
+#include <cstring>
 
 #include <Uniform.h>
+#include <GLState.h>
 #include <Shader.h>
 
 namespace X3
@@ -16,6 +18,32 @@ namespace X3
         }
     }
 
+    Uniform::Uniform(const std::string& name, Shader* shaderProgram, const GLint& location)
+        : mName(name)
+        , mOwner(shaderProgram)
+        , mLocation(location)
+    {
+    }
+
+    bool Uniform::Changed(const void* data, const size_t& size) const
+    {
+        // Missing uniforms are never written
+        if (mLocation == -1) return false;
+
+        GLState& state = GLState::Inst();
+        bool changed = !state.Tracking() || size != mValueSize || std::memcmp(mValue.data(), data, size) != 0;
+        state.Count(GLCall::Uniform, changed);
+
+        // Values too large to compare are always written
+        if (changed)
+        {
+            mValueSize = size <= mValue.size() ? size : 0;
+            if (mValueSize > 0) std::memcpy(mValue.data(), data, mValueSize);
+        }
+
+        return changed;
+    }
+
     Uniform& Uniform::operator=(const glm::vec2& vector2D)
     {
         Set(vector2D);
@@ -26,12 +54,12 @@ namespace X3
 
     void Uniform::Set(const glm::vec2& vector2D) const
     {
-        glUniform2fv(mLocation, 1, reinterpret_cast<const GLfloat*>(&vector2D));
+        if (Changed(&vector2D, sizeof(glm::vec2))) glUniform2fv(mLocation, 1, reinterpret_cast<const GLfloat*>(&vector2D));
     }
 
     void Uniform::Set(const glm::vec2* vectors2D, GLsizei count) const
     {
-        glUniform2fv(mLocation, count, reinterpret_cast<const GLfloat*>(vectors2D));
+        if (Changed(vectors2D, count * sizeof(glm::vec2))) glUniform2fv(mLocation, count, reinterpret_cast<const GLfloat*>(vectors2D));
     }
 
     // Family of functions setting vec3 uniforms
@@ -44,12 +72,12 @@ namespace X3
 
     void Uniform::Set(const glm::vec3& vector3D) const
     {
-        glUniform3fv(mLocation, 1, reinterpret_cast<const GLfloat*>(&vector3D));
+        if (Changed(&vector3D, sizeof(glm::vec3))) glUniform3fv(mLocation, 1, reinterpret_cast<const GLfloat*>(&vector3D));
     }
 
     void Uniform::Set(const glm::vec3* vectors3D, GLsizei count) const
     {
-        glUniform3fv(mLocation, count, reinterpret_cast<const GLfloat*>(vectors3D));
+        if (Changed(vectors3D, count * sizeof(glm::vec3))) glUniform3fv(mLocation, count, reinterpret_cast<const GLfloat*>(vectors3D));
     }
 
     // Family of functions setting vec4 uniforms
@@ -62,12 +90,12 @@ namespace X3
 
     void Uniform::Set(const glm::vec4& vector4D) const
     {
-        glUniform4fv(mLocation, 1, reinterpret_cast<const GLfloat*>(&vector4D));
+        if (Changed(&vector4D, sizeof(glm::vec4))) glUniform4fv(mLocation, 1, reinterpret_cast<const GLfloat*>(&vector4D));
     }
 
     void Uniform::Set(const glm::vec4* vectors4D, GLsizei count) const
     {
-        glUniform4fv(mLocation, count, reinterpret_cast<const GLfloat*>(vectors4D));
+        if (Changed(vectors4D, count * sizeof(glm::vec4))) glUniform4fv(mLocation, count, reinterpret_cast<const GLfloat*>(vectors4D));
     }
 
     // Family of functions setting float uniforms
@@ -86,12 +114,12 @@ namespace X3
 
     void Uniform::Set(float floatValue) const
     {
-        glUniform1fv(mLocation, 1, static_cast<const float*>(&floatValue));
+        if (Changed(&floatValue, sizeof(float))) glUniform1fv(mLocation, 1, static_cast<const float*>(&floatValue));
     }
 
     void Uniform::Set(const float* floatValues, GLsizei count) const
     {
-        glUniform1fv(mLocation, count, floatValues);
+        if (Changed(floatValues, count * sizeof(float))) glUniform1fv(mLocation, count, floatValues);
     }
 
     // Family of functions setting integer uniforms
@@ -104,12 +132,12 @@ namespace X3
 
     void Uniform::Set(int integerValue) const
     {
-        glUniform1iv(mLocation, 1, static_cast<const int*>(&integerValue));
+        if (Changed(&integerValue, sizeof(int))) glUniform1iv(mLocation, 1, static_cast<const int*>(&integerValue));
     }
 
     void Uniform::Set(const int* integerValues, GLsizei count) const
     {
-        glUniform1iv(mLocation, count, integerValues);
+        if (Changed(integerValues, count * sizeof(int))) glUniform1iv(mLocation, count, integerValues);
     }
 
     // Family of functions setting 3x3 matrices uniforms
@@ -122,12 +150,12 @@ namespace X3
 
     void Uniform::Set(const glm::mat3& matrix) const
     {
-        glUniformMatrix3fv(mLocation, 1, false, reinterpret_cast<const GLfloat*>(&matrix));
+        if (Changed(&matrix, sizeof(glm::mat3))) glUniformMatrix3fv(mLocation, 1, false, reinterpret_cast<const GLfloat*>(&matrix));
     }
 
     void Uniform::Set(const glm::mat3* matrices, GLsizei count) const
     {
-        glUniformMatrix3fv(mLocation, count, false, reinterpret_cast<const GLfloat*>(matrices));
+        if (Changed(matrices, count * sizeof(glm::mat3))) glUniformMatrix3fv(mLocation, count, false, reinterpret_cast<const GLfloat*>(matrices));
     }
 
     // Family of functions setting 4x4 matrices uniforms
@@ -140,11 +168,11 @@ namespace X3
 
     void Uniform::Set(const glm::mat4& matrix) const
     {
-        glUniformMatrix4fv(mLocation, 1, false, reinterpret_cast<const GLfloat*>(&matrix));
+        if (Changed(&matrix, sizeof(glm::mat4))) glUniformMatrix4fv(mLocation, 1, false, reinterpret_cast<const GLfloat*>(&matrix));
     }
 
     void Uniform::Set(const glm::mat4* matrices, GLsizei count) const
     {
-        glUniformMatrix4fv(mLocation, count, false, reinterpret_cast<const GLfloat*>(matrices));
+        if (Changed(matrices, count * sizeof(glm::mat4))) glUniformMatrix4fv(mLocation, count, false, reinterpret_cast<const GLfloat*>(matrices));
     }
 }
\ No newline at end of file
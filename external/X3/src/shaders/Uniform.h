@@ -1,8 +1,10 @@
 #pragma once
 
 // STL
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <array>
 
 // GL
 #include <glm/glm.hpp>
@@ -13,6 +15,26 @@ namespace X3
     // Forward class declaration of ShaderProgram (because of cross-inclusion)
     class Shader;
 
+    /**
+     * Uniform name and its hash (FNV-1a), used as key in the shader uniform cache.
+     * Declared constexpr, literal names are hashed at compile time.
+     */
+    struct UniformId
+    {
+        constexpr UniformId(const char* name) : Name(name), Hash(HashName(name)) {}
+        UniformId(const std::string& name) : UniformId(name.c_str()) {}
+
+        static constexpr uint64_t HashName(const char* name)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            while (*name) hash = (hash ^ static_cast<unsigned char>(*name++)) * 1099511628211ull;
+            return hash;
+        }
+
+        const char* Name; // only valid while the id is used
+        uint64_t Hash;
+    };
+
     /**
      * Wraps OpenGL shader uniform variable.
      */
@@ -21,6 +43,7 @@ namespace X3
     public:
         Uniform() = default; // Required to work with ShaderProgram [] operator
         Uniform(const std::string& name, Shader* shaderProgram);
+        Uniform(const std::string& name, Shader* shaderProgram, const GLint& location);
 
         // Family of functions setting vec2 uniforms
         Uniform& operator=(const glm::vec2& vector2D);
@@ -58,9 +81,20 @@ namespace X3
         void Set(const glm::mat4& matrix) const;
         void Set(const glm::mat4* matrices, GLsizei count = 1) const;
 
+        // Get/Set
+        GLint Location() const { return mLocation; }
+        const std::string& Name() const { return mName; }
+
     private:
         std::string mName; // Name of the uniform variable
         Shader* mOwner{ nullptr }; // Pointer to shader program this uniform belongs to
         GLint mLocation{ -1 }; // OpenGL assigned uniform location (cached in this variable)
+
+        // Last value written, equal writes are skipped
+        mutable std::array<unsigned char, 64> mValue;
+        mutable size_t mValueSize{ 0 };
+
+        // Helpers
+        bool Changed(const void* data, const size_t& size) const;
     };
 } // namespace X3
\ No newline at end of file
@@ -0,0 +1,398 @@
+// STL
+#include <algorithm>
+
+// X3
+#include <Bvh.h>
+
+namespace X3
+{
+	// Surface area, used as insertion cost
+	static float Area(const glm::vec3& min, const glm::vec3& max)
+	{
+		glm::vec3 d = max - min;
+		return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	Bvh::Bvh(const float& margin)
+	{
+		mNumProxies = 0;
+		mMargin = margin;
+		mFreeList = -1;
+		mRoot = -1;
+	}
+
+	int Bvh::Insert(const XM::AABB& box, Renderable* data)
+	{
+		int proxy = AllocateNode();
+
+		// Leaves keep an enlarged box
+		Node& leaf = mNodes[proxy];
+		leaf.Min = glm::vec3(box.LimitsX[0], box.LimitsY[0], box.LimitsZ[0]) - glm::vec3(mMargin);
+		leaf.Max = glm::vec3(box.LimitsX[1], box.LimitsY[1], box.LimitsZ[1]) + glm::vec3(mMargin);
+		leaf.Data = data;
+		leaf.Height = 0;
+
+		InsertLeaf(proxy);
+		mNumProxies++;
+
+		return proxy;
+	}
+
+	bool Bvh::Move(const int& proxy, const XM::AABB& box)
+	{
+		glm::vec3 min(box.LimitsX[0], box.LimitsY[0], box.LimitsZ[0]);
+		glm::vec3 max(box.LimitsX[1], box.LimitsY[1], box.LimitsZ[1]);
+
+		// Still inside the enlarged box, nothing to do
+		Node& leaf = mNodes[proxy];
+		if (glm::all(glm::lessThanEqual(leaf.Min, min)) && glm::all(glm::greaterThanEqual(leaf.Max, max))) return false;
+
+		// Otherwise reinsert with a new enlarged box
+		RemoveLeaf(proxy);
+		mNodes[proxy].Min = min - glm::vec3(mMargin);
+		mNodes[proxy].Max = max + glm::vec3(mMargin);
+		InsertLeaf(proxy);
+
+		return true;
+	}
+
+	void Bvh::Remove(const int& proxy)
+	{
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		mNumProxies--;
+	}
+
+	void Bvh::Clear()
+	{
+		mNodes.clear();
+		mNumProxies = 0;
+		mFreeList = -1;
+		mRoot = -1;
+	}
+
+	void Bvh::Query(const Frustum& frustum, std::vector<Renderable*>& result) const
+	{
+		if (mRoot == -1) return;
+
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(mRoot);
+
+		while (!stack.empty())
+		{
+			int index = stack.back();
+			stack.pop_back();
+
+			const Node& node = mNodes[index];
+			FrustumTest test = frustum.Test(node.Min, node.Max);
+
+			// Skip whole subtree, take whole subtree or keep descending
+			if (test == FrustumTest::Outside) continue;
+
+			if (test == FrustumTest::Inside) CollectLeaves(index, result);
+			else if (node.IsLeaf()) result.push_back(node.Data);
+			else
+			{
+				stack.push_back(node.Child1);
+				stack.push_back(node.Child2);
+			}
+		}
+	}
+
+	int Bvh::AllocateNode()
+	{
+		int index;
+
+		// Reuse a free node or grow the pool
+		if (mFreeList != -1)
+		{
+			index = mFreeList;
+			mFreeList = mNodes[index].Parent;
+		}
+		else
+		{
+			index = static_cast<int>(mNodes.size());
+			mNodes.emplace_back();
+		}
+
+		Node& node = mNodes[index];
+		node.Data = nullptr;
+		node.Parent = -1;
+		node.Child1 = -1;
+		node.Child2 = -1;
+		node.Height = 0;
+
+		return index;
+	}
+
+	void Bvh::FreeNode(const int& node)
+	{
+		mNodes[node].Parent = mFreeList;
+		mNodes[node].Height = -1;
+		mFreeList = node;
+	}
+
+	void Bvh::InsertLeaf(const int& leaf)
+	{
+		if (mRoot == -1)
+		{
+			mRoot = leaf;
+			mNodes[leaf].Parent = -1;
+			return;
+		}
+
+		// Finds the best sibling by descending on the cheapest surface area increase
+		glm::vec3 leafMin = mNodes[leaf].Min;
+		glm::vec3 leafMax = mNodes[leaf].Max;
+
+		int index = mRoot;
+		while (!mNodes[index].IsLeaf())
+		{
+			const Node& node = mNodes[index];
+
+			float area = Area(node.Min, node.Max);
+			float combinedArea = Area(glm::min(node.Min, leafMin), glm::max(node.Max, leafMax));
+
+			// Cost of creating a new parent here, and the cost pushed down to children
+			float cost = 2.f * combinedArea;
+			float inheritance = 2.f * (combinedArea - area);
+
+			auto childCost = [&](const int& c)
+			{
+				const Node& child = mNodes[c];
+				float grown = Area(glm::min(child.Min, leafMin), glm::max(child.Max, leafMax));
+				return child.IsLeaf() ? grown + inheritance : grown - Area(child.Min, child.Max) + inheritance;
+			};
+
+			float cost1 = childCost(node.Child1);
+			float cost2 = childCost(node.Child2);
+
+			if (cost < cost1 && cost < cost2) break;
+			index = cost1 < cost2 ? node.Child1 : node.Child2;
+		}
+
+		// Creates a new parent for sibling and leaf (may reallocate the pool)
+		int sibling = index;
+		int oldParent = mNodes[sibling].Parent;
+		int newParent = AllocateNode();
+
+		mNodes[newParent].Parent = oldParent;
+		mNodes[newParent].Min = glm::min(mNodes[sibling].Min, leafMin);
+		mNodes[newParent].Max = glm::max(mNodes[sibling].Max, leafMax);
+		mNodes[newParent].Height = mNodes[sibling].Height + 1;
+		mNodes[newParent].Child1 = sibling;
+		mNodes[newParent].Child2 = leaf;
+
+		if (oldParent != -1)
+		{
+			if (mNodes[oldParent].Child1 == sibling) mNodes[oldParent].Child1 = newParent;
+			else mNodes[oldParent].Child2 = newParent;
+		}
+		else
+		{
+			mRoot = newParent;
+		}
+
+		mNodes[sibling].Parent = newParent;
+		mNodes[leaf].Parent = newParent;
+
+		// Fix heights and boxes up to the root
+		Refit(mNodes[leaf].Parent);
+	}
+
+	void Bvh::RemoveLeaf(const int& leaf)
+	{
+		if (leaf == mRoot)
+		{
+			mRoot = -1;
+			return;
+		}
+
+		int parent = mNodes[leaf].Parent;
+		int grandParent = mNodes[parent].Parent;
+		int sibling = mNodes[parent].Child1 == leaf ? mNodes[parent].Child2 : mNodes[parent].Child1;
+
+		// Sibling takes the place of the parent
+		if (grandParent != -1)
+		{
+			if (mNodes[grandParent].Child1 == parent) mNodes[grandParent].Child1 = sibling;
+			else mNodes[grandParent].Child2 = sibling;
+
+			mNodes[sibling].Parent = grandParent;
+			FreeNode(parent);
+			Refit(grandParent);
+		}
+		else
+		{
+			mRoot = sibling;
+			mNodes[sibling].Parent = -1;
+			FreeNode(parent);
+		}
+	}
+
+	void Bvh::Refit(int node)
+	{
+		while (node != -1)
+		{
+			node = Balance(node);
+
+			Node& n = mNodes[node];
+			const Node& c1 = mNodes[n.Child1];
+			const Node& c2 = mNodes[n.Child2];
+
+			n.Height = 1 + std::max(c1.Height, c2.Height);
+			n.Min = glm::min(c1.Min, c2.Min);
+			n.Max = glm::max(c1.Max, c2.Max);
+
+			node = n.Parent;
+		}
+	}
+
+	int Bvh::Balance(const int& iA)
+	{
+		// Tree rotations keep the hierarchy shallow (no allocations, references stay valid)
+		Node& A = mNodes[iA];
+		if (A.IsLeaf() || A.Height < 2) return iA;
+
+		int iB = A.Child1;
+		int iC = A.Child2;
+		Node& B = mNodes[iB];
+		Node& C = mNodes[iC];
+
+		int balance = C.Height - B.Height;
+
+		// Rotate C up
+		if (balance > 1)
+		{
+			int iF = C.Child1;
+			int iG = C.Child2;
+			Node& F = mNodes[iF];
+			Node& G = mNodes[iG];
+
+			// Swap A and C
+			C.Child1 = iA;
+			C.Parent = A.Parent;
+			A.Parent = iC;
+
+			if (C.Parent != -1)
+			{
+				if (mNodes[C.Parent].Child1 == iA) mNodes[C.Parent].Child1 = iC;
+				else mNodes[C.Parent].Child2 = iC;
+			}
+			else
+			{
+				mRoot = iC;
+			}
+
+			// Rotate
+			if (F.Height > G.Height)
+			{
+				C.Child2 = iF;
+				A.Child2 = iG;
+				G.Parent = iA;
+
+				A.Min = glm::min(B.Min, G.Min);
+				A.Max = glm::max(B.Max, G.Max);
+				C.Min = glm::min(A.Min, F.Min);
+				C.Max = glm::max(A.Max, F.Max);
+
+				A.Height = 1 + std::max(B.Height, G.Height);
+				C.Height = 1 + std::max(A.Height, F.Height);
+			}
+			else
+			{
+				C.Child2 = iG;
+				A.Child2 = iF;
+				F.Parent = iA;
+
+				A.Min = glm::min(B.Min, F.Min);
+				A.Max = glm::max(B.Max, F.Max);
+				C.Min = glm::min(A.Min, G.Min);
+				C.Max = glm::max(A.Max, G.Max);
+
+				A.Height = 1 + std::max(B.Height, F.Height);
+				C.Height = 1 + std::max(A.Height, G.Height);
+			}
+
+			return iC;
+		}
+
+		// Rotate B up
+		if (balance < -1)
+		{
+			int iD = B.Child1;
+			int iE = B.Child2;
+			Node& D = mNodes[iD];
+			Node& E = mNodes[iE];
+
+			// Swap A and B
+			B.Child1 = iA;
+			B.Parent = A.Parent;
+			A.Parent = iB;
+
+			if (B.Parent != -1)
+			{
+				if (mNodes[B.Parent].Child1 == iA) mNodes[B.Parent].Child1 = iB;
+				else mNodes[B.Parent].Child2 = iB;
+			}
+			else
+			{
+				mRoot = iB;
+			}
+
+			// Rotate
+			if (D.Height > E.Height)
+			{
+				B.Child2 = iD;
+				A.Child1 = iE;
+				E.Parent = iA;
+
+				A.Min = glm::min(C.Min, E.Min);
+				A.Max = glm::max(C.Max, E.Max);
+				B.Min = glm::min(A.Min, D.Min);
+				B.Max = glm::max(A.Max, D.Max);
+
+				A.Height = 1 + std::max(C.Height, E.Height);
+				B.Height = 1 + std::max(A.Height, D.Height);
+			}
+			else
+			{
+				B.Child2 = iE;
+				A.Child1 = iD;
+				D.Parent = iA;
+
+				A.Min = glm::min(C.Min, D.Min);
+				A.Max = glm::max(C.Max, D.Max);
+				B.Min = glm::min(A.Min, E.Min);
+				B.Max = glm::max(A.Max, E.Max);
+
+				A.Height = 1 + std::max(C.Height, D.Height);
+				B.Height = 1 + std::max(A.Height, E.Height);
+			}
+
+			return iB;
+		}
+
+		return iA;
+	}
+
+	void Bvh::CollectLeaves(const int& node, std::vector<Renderable*>& result) const
+	{
+		std::vector<int> stack;
+		stack.push_back(node);
+
+		while (!stack.empty())
+		{
+			const Node& n = mNodes[stack.back()];
+			stack.pop_back();
+
+			if (n.IsLeaf()) result.push_back(n.Data);
+			else
+			{
+				stack.push_back(n.Child1);
+				stack.push_back(n.Child2);
+			}
+		}
+	}
+} // namespace X3
@@ -0,0 +1,72 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// GL
+#include <glm/glm.hpp>
+
+// X3
+#include <Frustum.h>
+
+// Math
+#include <XMath.cuh>
+
+namespace X3
+{
+	// Cross-definition
+	class Renderable;
+
+	// Dynamic bounding volume hierarchy over world-space AABBs. Leaves store
+	// enlarged ("fat") boxes so small motions do not touch the tree.
+	class Bvh
+	{
+	public:
+
+		// Constructor
+		Bvh(const float& margin = 0.1f);
+
+		// Common methods
+		int Insert(const XM::AABB& box, Renderable* data);
+		bool Move(const int& proxy, const XM::AABB& box);
+		void Remove(const int& proxy);
+		void Clear();
+
+		// Appends all proxies whose box overlaps the frustum
+		void Query(const Frustum& frustum, std::vector<Renderable*>& result) const;
+
+		// Get/Set
+		int NumProxies() { return mNumProxies; }
+		int Height() { return mRoot == -1 ? 0 : mNodes[mRoot].Height; }
+
+	private:
+
+		// Tree node, leaves have no children
+		struct Node
+		{
+			glm::vec3 Min, Max;
+			Renderable* Data;
+			int Parent; // next free node when in free list
+			int Child1, Child2;
+			int Height; // leaf = 0, free = -1
+
+			bool IsLeaf() const { return Child1 == -1; }
+		};
+
+		// Tree data
+		std::vector<Node> mNodes;
+		int mNumProxies;
+		int mFreeList;
+		float mMargin;
+		int mRoot;
+
+		// Helpers
+		int AllocateNode();
+		void FreeNode(const int& node);
+		void InsertLeaf(const int& leaf);
+		void RemoveLeaf(const int& leaf);
+		void Refit(int node);
+		int Balance(const int& a);
+		void CollectLeaves(const int& node, std::vector<Renderable*>& result) const;
+	};
+} // namespace X3
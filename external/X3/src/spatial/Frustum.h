@@ -0,0 +1,55 @@
+#pragma once
+
+// GL
+#include <glm/glm.hpp>
+
+namespace X3
+{
+	// Result of a frustum-volume test
+	enum class FrustumTest { Outside, Intersect, Inside };
+
+	// View frustum as six normalized planes (left, right, bottom, top, near, far)
+	struct Frustum
+	{
+		glm::vec4 Planes[6];
+
+		// Default constructor
+		Frustum() {}
+
+		// Extracts planes from a projection * view matrix (Gribb-Hartmann)
+		Frustum(const glm::mat4& matPV)
+		{
+			glm::vec4 row0(matPV[0][0], matPV[1][0], matPV[2][0], matPV[3][0]);
+			glm::vec4 row1(matPV[0][1], matPV[1][1], matPV[2][1], matPV[3][1]);
+			glm::vec4 row2(matPV[0][2], matPV[1][2], matPV[2][2], matPV[3][2]);
+			glm::vec4 row3(matPV[0][3], matPV[1][3], matPV[2][3], matPV[3][3]);
+
+			Planes[0] = row3 + row0;
+			Planes[1] = row3 - row0;
+			Planes[2] = row3 + row1;
+			Planes[3] = row3 - row1;
+			Planes[4] = row3 + row2;
+			Planes[5] = row3 - row2;
+
+			for (auto& p : Planes) p /= glm::length(glm::vec3(p));
+		}
+
+		// Classifies an axis-aligned box against the frustum
+		FrustumTest Test(const glm::vec3& min, const glm::vec3& max) const
+		{
+			FrustumTest result = FrustumTest::Inside;
+
+			for (const auto& p : Planes)
+			{
+				// Box corners furthest along and against the plane normal
+				glm::vec3 pos(p.x >= 0.f ? max.x : min.x, p.y >= 0.f ? max.y : min.y, p.z >= 0.f ? max.z : min.z);
+				glm::vec3 neg(p.x >= 0.f ? min.x : max.x, p.y >= 0.f ? min.y : max.y, p.z >= 0.f ? min.z : max.z);
+
+				if (glm::dot(glm::vec3(p), pos) + p.w < 0.f) return FrustumTest::Outside;
+				if (glm::dot(glm::vec3(p), neg) + p.w < 0.f) result = FrustumTest::Intersect;
+			}
+
+			return result;
+		}
+	};
+} // namespace X3
@@ -8,13 +8,17 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+// X3
+#include <GLState.h>
+
 namespace X3
 {
 	Texture2D::Texture2D(const std::string& fName, GLenum filterMin, GLenum filterMag, GLint wrap, int comp)
 	{
 
 		// Setup internals
-		unsigned char* imgData = nullptr;
+		mFileName = fName;
+		void* imgData = nullptr;
 		GLenum internalFormat = GL_RGBA;
 		GLenum type = GL_UNSIGNED_BYTE;
 		GLenum format = GL_RGBA;
@@ -27,22 +31,29 @@ namespace X3
 		{
 			int numChannels;
 			stbi_set_flip_vertically_on_load(1);
-			imgData = stbi_load(fName.c_str(), &w, &h, &numChannels, comp);
 
 			// Single channel
 			if (comp == STBI_grey)
 			{
+				imgData = stbi_load(fName.c_str(), &w, &h, &numChannels, comp);
 				internalFormat = GL_R8;
 				format = GL_RED;
 			}
 
+			// Decoded as floats to match the upload type, like the async path
 			else if (stbi_is_hdr(fName.c_str()))
 			{
+				imgData = stbi_loadf(fName.c_str(), &w, &h, &numChannels, STBI_rgb);
 				internalFormat = GL_RGB32F;
 				wrap = GL_CLAMP_TO_EDGE;
 				format = GL_RGB;
 				type = GL_FLOAT;
 			}
+
+			else
+			{
+				imgData = stbi_load(fName.c_str(), &w, &h, &numChannels, comp);
+			}
 		}
 		else
 		{
@@ -123,6 +134,7 @@ namespace X3
 
 		GenTexture();
 		Data(textureData);
+		delete[] textureData;
 	}
 
 	Texture2D::Texture2D(const Texture2DParams& params, void* data)
@@ -142,14 +154,12 @@ namespace X3
 
 	void Texture2D::Bind(GLenum text)
 	{
-		glActiveTexture(text);
-		glBindTexture(mParams.Target, mID);
+		GLState::Inst().BindTexture(text, mParams.Target, mID);
 	}
 
 	void Texture2D::Unbind(GLenum text)
 	{
-		glActiveTexture(text);
-		glBindTexture(mParams.Target, 0);
+		GLState::Inst().BindTexture(text, mParams.Target, 0);
 	}
 
 	void Texture2D::Resize(glm::ivec2 wh)
@@ -176,15 +186,15 @@ namespace X3
 	{
 		if (mParams.Target == GL_TEXTURE_2D_MULTISAMPLE)
 		{
-			glBindTexture(mParams.Target, mID);
+			GLState::Inst().BindTexture(mParams.Target, mID);
 			glTexImage2DMultisample(mParams.Target, mParams.Samples, mParams.InternalFormat, mParams.Width, mParams.Height, GL_TRUE);
-			glBindTexture(mParams.Target, 0);
+			GLState::Inst().BindTexture(mParams.Target, 0);
 		}
 		else
 		{
-			glBindTexture(mParams.Target, mID);
+			GLState::Inst().BindTexture(mParams.Target, mID);
 			glTexImage2D(mParams.Target, 0, mParams.InternalFormat, mParams.Width, mParams.Height, 0, mParams.Format, mParams.Type, data);
-			glBindTexture(mParams.Target, 0);
+			GLState::Inst().BindTexture(mParams.Target, 0);
 
 			Filters(mParams.FilterMin, mParams.FilterMag);
 			Wrap(mParams.Wrap);
@@ -192,20 +202,29 @@ namespace X3
 
 		if (MipMapEnabled())
 		{
+			GLState::Inst().BindTexture(mParams.Target, mID);
 			glTexParameteri(mParams.Target, GL_TEXTURE_BASE_LEVEL, 0);
 			glTexParameteri(mParams.Target, GL_TEXTURE_MAX_LEVEL, 3);
+			GLState::Inst().BindTexture(mParams.Target, 0);
 
 			GenMipMaps();
 		}
 	}
 
+	void Texture2D::Image(const Texture2DParams& params, void* data)
+	{
+		// Same texture object, users keep their references
+		mParams = params;
+		Data(data);
+	}
+
 	void Texture2D::GenMipMaps()
 	{
 		if (!MipMapEnabled()) return;
 
-		glBindTexture(mParams.Target, mID);
+		GLState::Inst().BindTexture(mParams.Target, mID);
 		glGenerateMipmap(mParams.Target);
-		glBindTexture(mParams.Target, 0);
+		GLState::Inst().BindTexture(mParams.Target, 0);
 	}
 
 	void Texture2D::Filters(const GLenum& filterMin, const GLenum& filterMag)
@@ -213,20 +232,20 @@ namespace X3
 		mParams.FilterMin = filterMin;
 		mParams.FilterMag = filterMag;
 
-		glBindTexture(mParams.Target, mID);
+		GLState::Inst().BindTexture(mParams.Target, mID);
 		glTexParameteri(mParams.Target, GL_TEXTURE_MIN_FILTER, mParams.FilterMin);
 		glTexParameteri(mParams.Target, GL_TEXTURE_MAG_FILTER, mParams.FilterMag);
-		glBindTexture(mParams.Target, 0);
+		GLState::Inst().BindTexture(mParams.Target, 0);
 	}
 
 	void Texture2D::Wrap(const GLint& wrap)
 	{
 		mParams.Wrap = wrap;
 
-		glBindTexture(mParams.Target, mID);
+		GLState::Inst().BindTexture(mParams.Target, mID);
 		glTexParameteri(mParams.Target, GL_TEXTURE_WRAP_S, mParams.Wrap);
 		glTexParameteri(mParams.Target, GL_TEXTURE_WRAP_T, mParams.Wrap);
-		glBindTexture(mParams.Target, 0);
+		GLState::Inst().BindTexture(mParams.Target, 0);
 
 	}
 
@@ -249,6 +268,7 @@ namespace X3
 	void Texture2D::DeleteTexture()
 	{
 		glDeleteTextures(1, &mID);
+		GLState::Inst().OnDeleteTexture(mID);
 	}
 
 	void Texture2D::GenTexture()
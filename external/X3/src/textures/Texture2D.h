@@ -41,6 +41,7 @@ namespace X3
 		void Resize(glm::ivec2 wh);
 		void Resize(int w, int h);
 		void Data(void* data);
+		void Image(const Texture2DParams& params, void* data);
 		void GenMipMaps();
 
 		// Set/Get
@@ -54,6 +55,8 @@ namespace X3
 		GLint Width() const { return mParams.Width; }
 		GLenum Type() const { return mParams.Type; }
 		GLint Wrap() const { return mParams.Wrap; }
+		void FileName(const std::string& fName) { mFileName = fName; }
+		std::string FileName() const { return mFileName; }
 		bool IsResident() { return mResident; }
 		GLuint Id() { return mID; }
 
@@ -68,6 +71,7 @@ namespace X3
 
 		// Texture data
 		Texture2DParams mParams;
+		std::string mFileName; // source image, empty for generated textures
 		bool mResident;
 		GLuint mID;
 
@@ -1,14 +1,36 @@
+// STL
+#include <filesystem>
+#include <cstring>
+
+// X3
+#include <Parameters.h>
 #include <Textures.h>
+#include <Profiler.h>
 
 namespace X3
 {
+    // Elapsed milliseconds
+    static float Ms(const std::chrono::steady_clock::time_point& start)
+    {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
     Textures2D& Textures2D::Inst()
     {
         static Textures2D tex;
         return tex;
     }
 
-    std::shared_ptr<Texture2D> Textures2D::Load(const std::string& fName, const std::string& key, GLenum filterMin, GLenum filterMag, GLint wrap, int comp)
+    Textures2D::~Textures2D()
+    {
+        // Workers may still be pushing decoded images
+        mPool.Stop();
+
+        for (auto& image : mDecoded) stbi_image_free(image.Data);
+        if (mPbo != 0) glDeleteBuffers(1, &mPbo);
+    }
+
+    std::shared_ptr<Texture2D> Textures2D::Load(const std::string& fName, const std::string& key, GLenum filterMin, GLenum filterMag, GLint wrap, int comp, bool async)
     {
 
         std::string nKey;
@@ -25,10 +47,39 @@ namespace X3
             nKey = key;
         }
 
-        // Checks if already loaded
-        if (!ContainsTexture(nKey)) TextureCache[nKey] = std::make_shared<Texture2D>(fName, filterMin, filterMag, wrap, comp);
+        // Checks if already loaded, keys are not expected to change parameters
+        if (ContainsTexture(nKey))
+        {
+            std::shared_ptr<Texture2D> cached = TextureCache.at(nKey);
+            if (cached->FilterMin() != filterMin || cached->FilterMag() != filterMag || cached->Wrap() != wrap)
+            {
+                printf("Texture %s already loaded with other sampling parameters\n", nKey.c_str());
+            }
+            return cached;
+        }
+
+        // Same file and parameters under another key shares the texture
+        std::string path = std::filesystem::absolute(fName).lexically_normal().generic_string();
+        path += "|" + std::to_string(comp) + "|" + std::to_string(filterMin) + "|" + std::to_string(filterMag) + "|" + std::to_string(wrap);
+        auto file = mFiles.find(path);
+        std::shared_ptr<Texture2D> texture = file != mFiles.end() ? file->second.lock() : nullptr;
+
+        if (!texture && async)
+        {
+            // Black placeholder until the image is resident
+            texture = std::make_shared<Texture2D>(glm::vec4(0.f, 0.f, 0.f, 255.f), 1, 1, filterMin, filterMag, wrap);
+            texture->FileName(fName);
+            Request(texture, fName, comp);
+        }
+        else if (!texture)
+        {
+            texture = std::make_shared<Texture2D>(fName, filterMin, filterMag, wrap, comp);
+        }
 
-        return TextureCache.at(nKey);
+        TextureCache[nKey] = texture;
+        mFiles[path] = texture;
+
+        return texture;
     }
 
     std::string Textures2D::Create(const std::string& key, const glm::vec4& color, GLenum filterMin, GLenum filterMag, GLint wrap, int comp)
@@ -55,13 +106,171 @@ namespace X3
         return TextureCache.at(key);
     }
 
+    void Textures2D::Update()
+    {
+        ProfileZone zone("Textures2D::Update");
+
+        size_t budget = (size_t)Parameters::Inst().RenderSettings.TextureUploadMB << 20;
+        size_t uploaded = 0;
+        bool processed = false;
+
+        while (true)
+        {
+            DecodedImage image;
+            {
+                std::lock_guard<std::mutex> lock(mDecodedMutex);
+
+                // At least one image per frame, whatever its size
+                if (mDecoded.empty() || (processed && uploaded + mDecoded.front().Bytes > budget)) break;
+
+                image = std::move(mDecoded.front());
+                mDecoded.pop_front();
+            }
+
+            Upload(image);
+            uploaded += image.Bytes;
+            processed = true;
+        }
+
+        // Batch time, shown through Stats()
+        if (processed && Pending() == 0) mStats.TotalMs = Ms(mBatchStart);
+    }
+
+    void Textures2D::Finish()
+    {
+        while (Pending() > 0)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mDecodedMutex);
+                mDecodedCondition.wait(lock, [this]() { return !mDecoded.empty(); });
+            }
+            Update();
+        }
+    }
+
     void Textures2D::ClearTextureCache()
     {
         TextureCache.clear();
+        mFiles.clear();
     }
 
     bool Textures2D::ContainsTexture(const std::string& key) const
     {
         return TextureCache.count(key) > 0;
     }
-}
\ No newline at end of file
+
+    void Textures2D::Request(std::shared_ptr<Texture2D> texture, const std::string& fName, int comp)
+    {
+        // New batch when idle
+        if (Pending() == 0)
+        {
+            mStats = TextureStats();
+            mBatchStart = std::chrono::steady_clock::now();
+        }
+        mStats.Requested++;
+
+        std::weak_ptr<Texture2D> target = texture;
+        mPool.Push([this, target, fName, comp]()
+        {
+            DecodedImage image = Decode(fName, comp);
+            image.Texture = target;
+            {
+                std::lock_guard<std::mutex> lock(mDecodedMutex);
+                mDecoded.push_back(std::move(image));
+            }
+            mDecodedCondition.notify_one();
+        });
+    }
+
+    Textures2D::DecodedImage Textures2D::Decode(const std::string& fName, int comp)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        DecodedImage image;
+        image.FileName = fName;
+        int numChannels = 0;
+
+        // Flip flag is global in stb, set per worker
+        stbi_set_flip_vertically_on_load_thread(1);
+
+        if (comp != STBI_grey && stbi_is_hdr(fName.c_str()))
+        {
+            image.Data = stbi_loadf(fName.c_str(), &image.Width, &image.Height, &numChannels, STBI_rgb);
+            image.InternalFormat = GL_RGB32F;
+            image.Format = GL_RGB;
+            image.Type = GL_FLOAT;
+            image.Hdr = true;
+            image.Bytes = (size_t)image.Width * image.Height * 3 * sizeof(float);
+        }
+        else
+        {
+            image.Data = stbi_load(fName.c_str(), &image.Width, &image.Height, &numChannels, comp);
+            int channels = comp == STBI_default ? numChannels : comp;
+
+            // Formats indexed by channel count
+            const GLenum internalFormats[] = { GL_R8, GL_R8, GL_RG8, GL_RGB8, GL_RGBA };
+            const GLenum formats[] = { GL_RED, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+            image.InternalFormat = internalFormats[channels];
+            image.Format = formats[channels];
+            image.Bytes = (size_t)image.Width * image.Height * channels;
+        }
+
+        image.DecodeMs = Ms(start);
+        return image;
+    }
+
+    void Textures2D::Upload(DecodedImage& image)
+    {
+        auto start = std::chrono::steady_clock::now();
+        mStats.DecodeMs += image.DecodeMs;
+
+        if (!image.Data)
+        {
+            printf("Texture at %s could not be loaded\n", image.FileName.c_str());
+            mStats.Failed++;
+            return;
+        }
+
+        // Texture may have been released while decoding
+        std::shared_ptr<Texture2D> texture = image.Texture.lock();
+        if (texture)
+        {
+            Texture2DParams params = texture->Params();
+            params.InternalFormat = image.InternalFormat;
+            params.Height = image.Height;
+            params.Width = image.Width;
+            params.Format = image.Format;
+            params.Type = image.Type;
+            if (image.Hdr) params.Wrap = GL_CLAMP_TO_EDGE;
+
+            // Copies through a pixel buffer, orphaned per image so it never waits on the previous transfer
+            if (mPbo == 0) glGenBuffers(1, &mPbo);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mPbo);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, image.Bytes, nullptr, GL_STREAM_DRAW);
+            void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, image.Bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+            // Rows of one and three channel images are not always 4 byte aligned
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            if (mapped)
+            {
+                std::memcpy(mapped, image.Data, image.Bytes);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                texture->Image(params, nullptr); // offset into the pixel buffer
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+            else
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                texture->Image(params, image.Data);
+            }
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            mStats.UploadedBytes += image.Bytes;
+        }
+
+        stbi_image_free(image.Data);
+        mStats.Loaded++;
+        mStats.UploadMs += Ms(start);
+    }
+}
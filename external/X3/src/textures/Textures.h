@@ -1,16 +1,32 @@
 #pragma once
 
 // STL
+#include <condition_variable>
 #include <iostream>
+#include <chrono>
 #include <string>
+#include <deque>
+#include <mutex>
 #include <map>
 #include <memory>
 
 // XE
+#include <ThreadPool.h>
 #include <Texture2D.h>
 
 namespace X3
 {
+	// Counters of file textures since the last idle point
+	struct TextureStats
+	{
+		int Requested = 0;
+		int Loaded = 0;
+		int Failed = 0;
+		float DecodeMs = 0.f; // summed over workers
+		float UploadMs = 0.f;
+		float TotalMs = 0.f; // wall time of the last completed batch
+		size_t UploadedBytes = 0;
+	};
 
 	// Singleton class that manages and keeps track of all textures.
 	class Textures2D
@@ -20,9 +36,11 @@ namespace X3
 
 		// Gets the one and only instance of the texture manager.
 		static Textures2D& Inst();
+		~Textures2D();
 
-		// Loads new texture and stores it with specified key.
-		std::shared_ptr<Texture2D> Load(const std::string& fName, const std::string& key = "", GLenum filterMin = GL_LINEAR_MIPMAP_LINEAR, GLenum filterMag = GL_LINEAR, GLint wrap = GL_REPEAT, int comp = STBI_rgb_alpha);
+		// Loads new texture and stores it with specified key. Asynchronous loads return a placeholder
+		// that becomes the image once decoded by the workers and uploaded by Update.
+		std::shared_ptr<Texture2D> Load(const std::string& fName, const std::string& key = "", GLenum filterMin = GL_LINEAR_MIPMAP_LINEAR, GLenum filterMag = GL_LINEAR, GLint wrap = GL_REPEAT, int comp = STBI_rgb_alpha, bool async = true);
 
 		// Creates texture of a given color
 		std::string Create(const std::string& key, const glm::vec4& color = glm::vec4(0.f, 0.f, 0.f, 1.f), GLenum filterMin = GL_LINEAR_MIPMAP_LINEAR, GLenum filterMag = GL_LINEAR, GLint wrap = GL_REPEAT, int comp = STBI_rgb_alpha);
@@ -33,16 +51,54 @@ namespace X3
 		// Returns texture with a specified key
 		std::shared_ptr<Texture2D> GetTexture(const std::string& key) const;
 
+		// Uploads decoded images within the frame budget, render thread only
+		void Update();
+
+		// Blocks until every requested texture is uploaded
+		void Finish();
+
 		// Deletes all textures
 		void ClearTextureCache();
 
 		// Get/Set
 		int CacheSize() { return TextureCache.size(); }
+		int Pending() const { return mStats.Requested - mStats.Loaded - mStats.Failed; }
+		const TextureStats& Stats() const { return mStats; }
 
 	private:
 
+		// Decoded image waiting for upload
+		struct DecodedImage
+		{
+			std::weak_ptr<Texture2D> Texture;
+			std::string FileName;
+			void* Data = nullptr; // stbi owned
+			int Width = 0;
+			int Height = 0;
+			GLenum InternalFormat = GL_RGBA;
+			GLenum Format = GL_RGBA;
+			GLenum Type = GL_UNSIGNED_BYTE;
+			bool Hdr = false;
+			size_t Bytes = 0;
+			float DecodeMs = 0.f;
+		};
+
 		// Data
 		std::map<std::string, std::shared_ptr<Texture2D>> TextureCache;
+		std::map<std::string, std::weak_ptr<Texture2D>> mFiles; // by normalized path and parameters, shared between keys
+
+		// Decoded images, filled by workers
+		std::deque<DecodedImage> mDecoded;
+		std::condition_variable mDecodedCondition;
+		std::mutex mDecodedMutex;
+
+		// Streaming upload
+		GLuint mPbo = 0;
+		TextureStats mStats;
+		std::chrono::steady_clock::time_point mBatchStart;
+
+		// Workers last, so they stop before the queue is destroyed
+		utils::ThreadPool mPool;
 
 		Textures2D() {} // Private constructor to make class singleton
 		Textures2D(const Textures2D&) = delete; // No copy constructor allowed
@@ -50,5 +106,8 @@ namespace X3
 
 		// Helpers
 		bool ContainsTexture(const std::string& key) const;
+		void Request(std::shared_ptr<Texture2D> texture, const std::string& fName, int comp);
+		static DecodedImage Decode(const std::string& fName, int comp);
+		void Upload(DecodedImage& image);
 	};
-} // namespace X3
\ No newline at end of file
+} // namespace X3
@@ -0,0 +1,71 @@
+// X3
+#include <MappedFile.h>
+
+// OS
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace X3
+{
+	namespace utils
+	{
+#ifdef _WIN32
+		MappedFile::MappedFile(const std::string& fn)
+		{
+			HANDLE file = CreateFileA(fn.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return;
+			mFile = file;
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+
+			mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mMapping) return;
+
+			mData = static_cast<const unsigned char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+			if (mData) mSize = static_cast<size_t>(size.QuadPart);
+		}
+
+		MappedFile::~MappedFile()
+		{
+			if (mData) UnmapViewOfFile(mData);
+			if (mMapping) CloseHandle(mMapping);
+			if (mFile) CloseHandle(mFile);
+		}
+#else
+		MappedFile::MappedFile(const std::string& fn)
+		{
+			int fd = open(fn.c_str(), O_RDONLY);
+			if (fd < 0) return;
+
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0)
+			{
+				void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED)
+				{
+					// Whole file is about to be read, start paging in
+					madvise(data, st.st_size, MADV_WILLNEED);
+					mData = static_cast<const unsigned char*>(data);
+					mSize = st.st_size;
+				}
+			}
+
+			// Mapping stays valid after closing the descriptor
+			close(fd);
+		}
+
+		MappedFile::~MappedFile()
+		{
+			if (mData) munmap(const_cast<unsigned char*>(mData), mSize);
+		}
+#endif
+	} // namespace utils
+} // namespace X3
@@ -0,0 +1,40 @@
+#pragma once
+
+// STL
+#include <cstddef>
+#include <string>
+
+namespace X3
+{
+	namespace utils
+	{
+		// Read-only memory mapping of a whole file
+		class MappedFile
+		{
+		public:
+
+			// Constructor
+			MappedFile(const std::string& fn);
+			~MappedFile();
+
+			// Get/Set
+			bool IsOpen() const { return mData != nullptr; }
+			const unsigned char* Data() const { return mData; }
+			size_t Size() const { return mSize; }
+
+		private:
+
+			// Mapping data
+			const unsigned char* mData = nullptr;
+			size_t mSize = 0;
+#ifdef _WIN32
+			void* mFile = nullptr;
+			void* mMapping = nullptr;
+#endif
+
+			// Helpers
+			MappedFile(const MappedFile&) = delete; // No copy constructor allowed
+			void operator=(const MappedFile&) = delete; // No copy assignment allowed
+		};
+	} // namespace utils
+} // namespace X3
@@ -0,0 +1,67 @@
+// STL
+#include <algorithm>
+
+// X3
+#include <ThreadPool.h>
+
+namespace X3
+{
+	namespace utils
+	{
+		ThreadPool::ThreadPool(const int& numThreads)
+		{
+			// Leaves one hardware thread for rendering
+			int n = numThreads > 0 ? numThreads : std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+			mWorkers.reserve(n);
+			for (int i = 0; i < n; i++) mWorkers.emplace_back(&ThreadPool::Work, this);
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			Stop();
+		}
+
+		void ThreadPool::Push(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (mStop) return;
+				mTasks.push(std::move(task));
+			}
+			mCondition.notify_one();
+		}
+
+		void ThreadPool::Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStop = true;
+			}
+			mCondition.notify_all();
+
+			for (auto& w : mWorkers)
+			{
+				if (w.joinable()) w.join();
+			}
+			mWorkers.clear();
+		}
+
+		void ThreadPool::Work()
+		{
+			while (true)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(mMutex);
+					mCondition.wait(lock, [this]() { return mStop || !mTasks.empty(); });
+					if (mStop) return;
+
+					task = std::move(mTasks.front());
+					mTasks.pop();
+				}
+				task();
+			}
+		}
+	} // namespace utils
+} // namespace X3
@@ -0,0 +1,48 @@
+#pragma once
+
+// STL
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <queue>
+
+namespace X3
+{
+	namespace utils
+	{
+		// Fixed set of worker threads consuming a FIFO of tasks
+		class ThreadPool
+		{
+		public:
+
+			// Constructor, zero threads picks one per spare hardware thread
+			ThreadPool(const int& numThreads = 0);
+			~ThreadPool();
+
+			// Queues a task, runs on any worker
+			void Push(std::function<void()> task);
+
+			// Joins workers, queued tasks that did not start are dropped
+			void Stop();
+
+			// Get/Set
+			int NumThreads() const { return mWorkers.size(); }
+
+		private:
+
+			// Workers and queue
+			std::vector<std::thread> mWorkers;
+			std::queue<std::function<void()>> mTasks;
+			std::condition_variable mCondition;
+			std::mutex mMutex;
+			bool mStop = false;
+
+			// Helpers
+			void Work();
+			ThreadPool(const ThreadPool&) = delete; // No copy constructor allowed
+			void operator=(const ThreadPool&) = delete; // No copy assignment allowed
+		};
+	} // namespace utils
+} // namespace X3